@@ -0,0 +1,191 @@
+﻿#include "Automaton.h"
+
+#include <iostream>
+
+#include "Diagnostics.h"
+
+using namespace std;
+
+uint32_t NameTable::intern(string_view name)
+{
+    auto it = ids.find(name);
+    if (it != ids.end())
+    {
+        return it->second;
+    }
+    return add(name);
+}
+
+uint32_t NameTable::add(string_view name)
+{
+    uint32_t id = uint32_t(names.size());
+    names.emplace_back(name);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+uint32_t NameTable::find(string_view name) const
+{
+    auto it = ids.find(name);
+    return it == ids.end() ? NO_STATE : it->second;
+}
+
+void NameTable::clear()
+{
+    names.clear();
+    ids.clear();
+}
+
+const string& stateName(const NameTable& states, StateId state)
+{
+    return state == NO_STATE ? UNDEFINED_NAME : states[state];
+}
+
+StateId resolveState(const NameTable& states, string_view name)
+{
+    return resolveState(states, name, cerr);
+}
+
+StateId resolveState(const NameTable& states, string_view name, ostream& errors)
+{
+    if (name.empty() || name == UNDEFINED_NAME)
+    {
+        return NO_STATE;
+    }
+
+    StateId state = states.find(name);
+    if (state == NO_STATE && logEnabled(Verbosity::Warning))
+    {
+        errors << "Error: Unknown state " << name << "." << endl;
+    }
+    return state;
+}
+
+namespace
+{
+    vector<StateId> makeRemap(size_t stateCount, const vector<StateId>& keep)
+    {
+        vector<StateId> remap(stateCount, NO_STATE);
+        for (size_t i = 0; i < keep.size(); i++)
+        {
+            remap[keep[i]] = StateId(i);
+        }
+        return remap;
+    }
+}
+
+MealyTable restrictStates(const MealyTable& mealy, const vector<StateId>& keep)
+{
+    MealyTable result;
+    result.inputs = mealy.inputs;
+    result.outputs = mealy.outputs;
+
+    size_t inputCount = mealy.inputCount();
+    vector<StateId> remap = makeRemap(mealy.stateCount(), keep);
+    result.next.resize(keep.size() * inputCount);
+    result.out.resize(keep.size() * inputCount);
+
+    for (size_t i = 0; i < keep.size(); i++)
+    {
+        result.states.add(mealy.states[keep[i]]);
+        for (size_t j = 0; j < inputCount; j++)
+        {
+            StateId target = mealy.nextState(keep[i], SymbolId(j));
+            result.next[i * inputCount + j] = target == NO_STATE ? NO_STATE : remap[target];
+            result.out[i * inputCount + j] = mealy.output(keep[i], SymbolId(j));
+        }
+    }
+
+    return result;
+}
+
+MooreTable restrictStates(const MooreTable& moore, const vector<StateId>& keep)
+{
+    MooreTable result;
+    result.inputs = moore.inputs;
+    result.outputs = moore.outputs;
+
+    size_t inputCount = moore.inputCount();
+    vector<StateId> remap = makeRemap(moore.stateCount(), keep);
+    result.next.resize(keep.size() * inputCount);
+    result.out.resize(keep.size());
+
+    for (size_t i = 0; i < keep.size(); i++)
+    {
+        result.states.add(moore.states[keep[i]]);
+        result.out[i] = moore.output(keep[i]);
+        for (size_t j = 0; j < inputCount; j++)
+        {
+            StateId target = moore.nextState(keep[i], SymbolId(j));
+            result.next[i * inputCount + j] = target == NO_STATE ? NO_STATE : remap[target];
+        }
+    }
+
+    return result;
+}
+
+namespace
+{
+    vector<StateId> blockRepresentatives(const vector<uint32_t>& blocks, uint32_t blockCount)
+    {
+        vector<StateId> representatives(blockCount, NO_STATE);
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            if (blocks[i] != NO_STATE && representatives[blocks[i]] == NO_STATE)
+            {
+                representatives[blocks[i]] = StateId(i);
+            }
+        }
+        return representatives;
+    }
+}
+
+MealyTable buildQuotient(const MealyTable& mealy, const vector<uint32_t>& blocks, uint32_t blockCount)
+{
+    MealyTable result;
+    result.inputs = mealy.inputs;
+    result.outputs = mealy.outputs;
+
+    size_t inputCount = mealy.inputCount();
+    vector<StateId> representatives = blockRepresentatives(blocks, blockCount);
+    result.next.resize(size_t(blockCount) * inputCount);
+    result.out.resize(size_t(blockCount) * inputCount);
+
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        result.states.add("q" + to_string(b));
+        for (size_t j = 0; j < inputCount; j++)
+        {
+            StateId target = mealy.nextState(representatives[b], SymbolId(j));
+            result.next[b * inputCount + j] = target == NO_STATE ? NO_STATE : blocks[target];
+            result.out[b * inputCount + j] = mealy.output(representatives[b], SymbolId(j));
+        }
+    }
+
+    return result;
+}
+
+MooreTable buildQuotient(const MooreTable& moore, const vector<uint32_t>& blocks, uint32_t blockCount)
+{
+    MooreTable result;
+    result.inputs = moore.inputs;
+    result.outputs = moore.outputs;
+
+    size_t inputCount = moore.inputCount();
+    vector<StateId> representatives = blockRepresentatives(blocks, blockCount);
+    result.next.resize(size_t(blockCount) * inputCount);
+    result.out.resize(blockCount);
+
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        result.states.add("q" + to_string(b));
+        result.out[b] = moore.output(representatives[b]);
+        for (size_t j = 0; j < inputCount; j++)
+        {
+            StateId target = moore.nextState(representatives[b], SymbolId(j));
+            result.next[b * inputCount + j] = target == NO_STATE ? NO_STATE : blocks[target];
+        }
+    }
+
+    return result;
+}
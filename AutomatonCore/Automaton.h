@@ -0,0 +1,92 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using StateId = uint32_t;
+using SymbolId = uint32_t;
+
+// Переход в неопределённое состояние ("-" или пустая ячейка во входной таблице).
+constexpr StateId NO_STATE = std::numeric_limits<StateId>::max();
+const std::string UNDEFINED_NAME = "-";
+
+struct NameHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
+// Таблица интернирования: каждому имени сопоставляется плотный номер 0..size()-1.
+struct NameTable
+{
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> ids;
+
+    // Возвращает номер имени, добавляя его при первом обращении.
+    uint32_t intern(std::string_view name);
+    // Всегда добавляет новый номер; поиск по имени вернёт первый из повторов.
+    uint32_t add(std::string_view name);
+    // Возвращает номер имени или NO_STATE, если имени нет.
+    uint32_t find(std::string_view name) const;
+
+    const std::string& operator[](uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+    void clear();
+};
+
+// Автомат Мили. Переходы и выходы хранятся плоскими массивами states × inputs:
+// next[state * inputCount() + input]. Начальным считается состояние 0.
+struct MealyTable
+{
+    NameTable states;
+    NameTable inputs;
+    NameTable outputs;
+    std::vector<StateId> next;
+    std::vector<SymbolId> out;
+
+    size_t stateCount() const { return states.size(); }
+    size_t inputCount() const { return inputs.size(); }
+    StateId nextState(StateId state, SymbolId input) const { return next[size_t(state) * inputs.size() + input]; }
+    SymbolId output(StateId state, SymbolId input) const { return out[size_t(state) * inputs.size() + input]; }
+};
+
+// Автомат Мура. next хранится так же, как у автомата Мили, out — по одному выходу на состояние.
+struct MooreTable
+{
+    NameTable states;
+    NameTable inputs;
+    NameTable outputs;
+    std::vector<StateId> next;
+    std::vector<SymbolId> out;
+
+    size_t stateCount() const { return states.size(); }
+    size_t inputCount() const { return inputs.size(); }
+    StateId nextState(StateId state, SymbolId input) const { return next[size_t(state) * inputs.size() + input]; }
+    SymbolId output(StateId state) const { return out[state]; }
+};
+
+// Имя состояния для записи: NO_STATE записывается как "-".
+const std::string& stateName(const NameTable& states, StateId state);
+
+// Номер состояния по имени из ячейки таблицы: "-" означает неопределённый переход,
+// о неизвестных именах сообщается в cerr, и переход тоже считается неопределённым.
+StateId resolveState(const NameTable& states, std::string_view name);
+// То же с сообщениями в errors вместо cerr.
+StateId resolveState(const NameTable& states, std::string_view name, std::ostream& errors);
+
+// Подавтомат из перечисленных состояний (в заданном порядке); переходы в
+// остальные состояния становятся неопределёнными.
+MealyTable restrictStates(const MealyTable& mealy, const std::vector<StateId>& keep);
+MooreTable restrictStates(const MooreTable& moore, const std::vector<StateId>& keep);
+
+// Фактор-автомат по разбиению blocks (блоки 0..blockCount-1, блок 0 — начальный).
+// Состояния называются "q0", "q1", ...; строка перехода берётся у первого состояния блока.
+// Состояния с блоком NO_STATE (например, недостижимые) в фактор-автомат не попадают.
+MealyTable buildQuotient(const MealyTable& mealy, const std::vector<uint32_t>& blocks, uint32_t blockCount);
+MooreTable buildQuotient(const MooreTable& moore, const std::vector<uint32_t>& blocks, uint32_t blockCount);
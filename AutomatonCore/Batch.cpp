@@ -0,0 +1,160 @@
+﻿#include "Batch.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct JobResult
+    {
+        bool ok = false;
+        string message;
+        double milliseconds = 0;
+    };
+
+    string_view trimLine(string_view line)
+    {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+        {
+            line.remove_suffix(1);
+        }
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+        {
+            line.remove_prefix(1);
+        }
+        return line;
+    }
+
+    string resolvePath(const fs::path& base, string_view path)
+    {
+        fs::path result(path);
+        return result.is_relative() ? (base / result).string() : result.string();
+    }
+}
+
+vector<BatchJob> readManifest(const string& fileName)
+{
+    MappedFile file(fileName);
+    string_view data = file.view();
+    if (data.substr(0, 3) == "\xEF\xBB\xBF")
+    {
+        data.remove_prefix(3);
+    }
+    fs::path base = fs::path(fileName).parent_path();
+
+    vector<BatchJob> jobs;
+    size_t lineNumber = 0;
+    while (!data.empty())
+    {
+        size_t lineEnd = data.find('\n');
+        string_view line = trimLine(data.substr(0, lineEnd));
+        data.remove_prefix(lineEnd == string_view::npos ? data.size() : lineEnd + 1);
+        lineNumber++;
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+
+        size_t first = line.find(';');
+        size_t second = first == string_view::npos ? first : line.find(';', first + 1);
+        if (second == string_view::npos)
+        {
+            throw runtime_error("Invalid manifest line " + to_string(lineNumber) + " in " + fileName);
+        }
+        jobs.push_back({ string(line.substr(0, first)),
+            resolvePath(base, line.substr(first + 1, second - first - 1)),
+            resolvePath(base, line.substr(second + 1)) });
+    }
+    return jobs;
+}
+
+vector<BatchJob> listDirectoryJobs(const string& mode, const string& inputDir, const string& outputDir)
+{
+    vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(inputDir))
+    {
+        string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && (extension == ".csv" || extension == ".bin"))
+        {
+            files.push_back(entry.path());
+        }
+    }
+    sort(files.begin(), files.end());
+    fs::create_directories(outputDir);
+
+    vector<BatchJob> jobs;
+    for (const auto& file : files)
+    {
+        jobs.push_back({ mode, file.string(), (fs::path(outputDir) / file.filename()).string() });
+    }
+    return jobs;
+}
+
+size_t runBatch(const vector<BatchJob>& jobs, const function<void(const BatchJob&)>& runJob,
+    ostream& report, ThreadPool& pool)
+{
+    // Крупные задания запускаются первыми, чтобы в конце пакета не ждать одно большое.
+    vector<uintmax_t> sizes(jobs.size());
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        error_code error;
+        sizes[i] = fs::file_size(jobs[i].input, error);
+        if (error)
+        {
+            sizes[i] = 0;
+        }
+    }
+    vector<size_t> order(jobs.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    auto batchStart = chrono::steady_clock::now();
+    vector<JobResult> results(jobs.size());
+    pool.parallelFor(jobs.size(), 1, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const BatchJob& job = jobs[order[i]];
+            JobResult& result = results[order[i]];
+            auto start = chrono::steady_clock::now();
+            try
+            {
+                runJob(job);
+                result.ok = true;
+            }
+            catch (const exception& e)
+            {
+                result.message = e.what();
+            }
+            result.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+    });
+    double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - batchStart).count();
+
+    size_t failed = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        const BatchJob& job = jobs[i];
+        const JobResult& result = results[i];
+        if (result.ok)
+        {
+            report << "OK     " << job.mode << " " << job.input << " -> " << job.output
+                << " (" << result.milliseconds << " ms)\n";
+        }
+        else
+        {
+            failed++;
+            report << "FAILED " << job.mode << " " << job.input << ": " << result.message << "\n";
+        }
+    }
+    report << "Batch: " << jobs.size() << " jobs, " << failed << " failed, " << totalSeconds << " s" << endl;
+    return failed;
+}
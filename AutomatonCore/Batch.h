@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Пакетный режим: много заданий в одном процессе на общем пуле потоков.
+struct BatchJob
+{
+    std::string mode;
+    std::string input;
+    std::string output;
+};
+
+// Манифест: по заданию в строке "режим;вход;выход"; пустые строки и строки,
+// начинающиеся с '#', пропускаются. Относительные пути отсчитываются от каталога манифеста.
+std::vector<BatchJob> readManifest(const std::string& fileName);
+
+// Задания для всех файлов .csv и .bin каталога inputDir (в порядке имён);
+// результат пишется в outputDir под тем же именем, каталог создаётся при необходимости.
+std::vector<BatchJob> listDirectoryJobs(const std::string& mode, const std::string& inputDir,
+    const std::string& outputDir);
+
+// Выполняет задания на pool, начиная с самых крупных входных файлов; вложенный
+// параллелизм заданий разбирают освободившиеся потоки. Исключение задания считается
+// его ошибкой. В report пишется строка о каждом задании (в порядке списка) и итог.
+// Возвращает число неудачных заданий.
+size_t runBatch(const std::vector<BatchJob>& jobs, const std::function<void(const BatchJob&)>& runJob,
+    std::ostream& report, ThreadPool& pool);
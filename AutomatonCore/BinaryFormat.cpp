@@ -0,0 +1,244 @@
+﻿#include "BinaryFormat.h"
+#include "MappedFile.h"
+#include "OutputFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+FileFormat resolveFormat(const string& fileName, const string& option)
+{
+    if (option == "bin")
+    {
+        return FileFormat::Binary;
+    }
+    if (option == "csv")
+    {
+        return FileFormat::Csv;
+    }
+    if (option == "cpp")
+    {
+        return FileFormat::Cpp;
+    }
+    if (!option.empty())
+    {
+        throw runtime_error("Unknown file format " + option);
+    }
+
+    auto hasExtension = [&](const string& extension)
+    {
+        return fileName.size() >= extension.size()
+            && fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+    };
+    if (hasExtension(BINARY_EXTENSION))
+    {
+        return FileFormat::Binary;
+    }
+    if (hasExtension(".cpp") || hasExtension(".h") || hasExtension(".hpp"))
+    {
+        return FileFormat::Cpp;
+    }
+    return FileFormat::Csv;
+}
+
+namespace
+{
+    uint64_t align8(uint64_t size)
+    {
+        return (size + 7) & ~uint64_t(7);
+    }
+
+    uint64_t nameTableSize(const NameTable& names)
+    {
+        uint64_t size = sizeof(uint32_t) * (names.size() + 2);
+        for (const auto& name : names.names)
+        {
+            size += name.size();
+        }
+        return align8(size);
+    }
+
+    void writePadding(ofstream& output, uint64_t size)
+    {
+        static const char zeros[8] = {};
+        output.write(zeros, streamsize(align8(size) - size));
+    }
+
+    void writeNameTable(ofstream& output, const NameTable& names)
+    {
+        vector<uint32_t> offsets;
+        offsets.push_back(uint32_t(names.size()));
+        uint32_t offset = 0;
+        offsets.push_back(offset);
+        for (const auto& name : names.names)
+        {
+            offset += uint32_t(name.size());
+            offsets.push_back(offset);
+        }
+        output.write(reinterpret_cast<const char*>(offsets.data()), streamsize(offsets.size() * sizeof(uint32_t)));
+        for (const auto& name : names.names)
+        {
+            output.write(name.data(), streamsize(name.size()));
+        }
+        writePadding(output, offsets.size() * sizeof(uint32_t) + offset);
+    }
+
+    template <typename Table>
+    void saveBinary(const string& fileName, const Table& table, AutomatonKind kind)
+    {
+        BinaryHeader header = {};
+        memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+        header.version = BINARY_VERSION;
+        header.byteOrder = BINARY_BYTE_ORDER;
+        header.kind = kind;
+        header.stateCount = uint32_t(table.stateCount());
+        header.inputCount = uint32_t(table.inputCount());
+        header.outputCount = uint32_t(table.outputs.size());
+        header.stateNamesOffset = sizeof(BinaryHeader);
+        header.inputNamesOffset = header.stateNamesOffset + nameTableSize(table.states);
+        header.outputNamesOffset = header.inputNamesOffset + nameTableSize(table.inputs);
+        header.nextOffset = header.outputNamesOffset + nameTableSize(table.outputs);
+        header.outOffset = header.nextOffset + align8(table.next.size() * sizeof(StateId));
+        header.fileSize = header.outOffset + align8(table.out.size() * sizeof(SymbolId));
+
+        OutputFile file(fileName, ios::binary);
+        ofstream& output = file.stream();
+        if (!output.is_open())
+        {
+            throw runtime_error("Cannot open file " + fileName + " for writing");
+        }
+
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeNameTable(output, table.states);
+        writeNameTable(output, table.inputs);
+        writeNameTable(output, table.outputs);
+        output.write(reinterpret_cast<const char*>(table.next.data()), streamsize(table.next.size() * sizeof(StateId)));
+        writePadding(output, table.next.size() * sizeof(StateId));
+        output.write(reinterpret_cast<const char*>(table.out.data()), streamsize(table.out.size() * sizeof(SymbolId)));
+        writePadding(output, table.out.size() * sizeof(SymbolId));
+
+        // Ошибки записи буфера становятся видны только после сброса в файл.
+        if (!file.commit())
+        {
+            throw runtime_error("Cannot write file " + fileName);
+        }
+    }
+
+    void checkSection(const MappedFile& file, uint64_t offset, uint64_t size)
+    {
+        if (offset % 8 != 0 || offset > file.size() || size > file.size() - offset)
+        {
+            throw runtime_error("Corrupted binary automaton file");
+        }
+    }
+
+    void readNameTable(const MappedFile& file, uint64_t offset, uint32_t expectedCount, NameTable& names)
+    {
+        checkSection(file, offset, sizeof(uint32_t));
+        const uint32_t* section = reinterpret_cast<const uint32_t*>(file.data() + offset);
+        uint32_t count = section[0];
+        if (count != expectedCount)
+        {
+            throw runtime_error("Corrupted binary automaton file");
+        }
+
+        const uint32_t* offsets = section + 1;
+        uint64_t blobOffset = offset + sizeof(uint32_t) * (uint64_t(count) + 2);
+        checkSection(file, offset, blobOffset - offset);
+        if (offsets[count] > file.size() - blobOffset)
+        {
+            throw runtime_error("Corrupted binary automaton file");
+        }
+
+        const char* blob = file.data() + blobOffset;
+        names.clear();
+        names.names.reserve(count);
+        names.ids.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (offsets[i] > offsets[i + 1])
+            {
+                throw runtime_error("Corrupted binary automaton file");
+            }
+            names.add(string_view(blob + offsets[i], offsets[i + 1] - offsets[i]));
+        }
+    }
+
+    template <typename Id>
+    void readArray(const MappedFile& file, uint64_t offset, size_t count, Id limit, bool allowUndefined, vector<Id>& values)
+    {
+        checkSection(file, offset, uint64_t(count) * sizeof(Id));
+        const Id* begin = reinterpret_cast<const Id*>(file.data() + offset);
+        values.assign(begin, begin + count);
+
+        bool valid = true;
+        for (auto value : values)
+        {
+            valid &= value < limit || (allowUndefined && value == NO_STATE);
+        }
+        if (!valid)
+        {
+            throw runtime_error("Corrupted binary automaton file");
+        }
+    }
+
+    template <typename Table>
+    void loadBinary(const string& fileName, Table& table, AutomatonKind kind)
+    {
+        MappedFile file(fileName);
+        if (file.size() < sizeof(BinaryHeader))
+        {
+            throw runtime_error("Not a binary automaton file: " + fileName);
+        }
+
+        BinaryHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0 || header.byteOrder != BINARY_BYTE_ORDER)
+        {
+            throw runtime_error("Not a binary automaton file: " + fileName);
+        }
+        if (header.version != BINARY_VERSION)
+        {
+            throw runtime_error("Unsupported binary automaton version " + to_string(header.version));
+        }
+        if (header.kind != kind)
+        {
+            throw runtime_error("Binary file " + fileName + " holds another kind of automaton");
+        }
+        if (header.fileSize != file.size())
+        {
+            throw runtime_error("Corrupted binary automaton file");
+        }
+
+        readNameTable(file, header.stateNamesOffset, header.stateCount, table.states);
+        readNameTable(file, header.inputNamesOffset, header.inputCount, table.inputs);
+        readNameTable(file, header.outputNamesOffset, header.outputCount, table.outputs);
+
+        size_t cellCount = size_t(header.stateCount) * header.inputCount;
+        size_t outCount = kind == AutomatonKind::Mealy ? cellCount : header.stateCount;
+        readArray(file, header.nextOffset, cellCount, header.stateCount, true, table.next);
+        readArray(file, header.outOffset, outCount, header.outputCount, false, table.out);
+    }
+}
+
+void saveMealyBinary(const string& fileName, const MealyTable& mealy)
+{
+    saveBinary(fileName, mealy, AutomatonKind::Mealy);
+}
+
+void loadMealyBinary(const string& fileName, MealyTable& mealy)
+{
+    loadBinary(fileName, mealy, AutomatonKind::Mealy);
+}
+
+void saveMooreBinary(const string& fileName, const MooreTable& moore)
+{
+    saveBinary(fileName, moore, AutomatonKind::Moore);
+}
+
+void loadMooreBinary(const string& fileName, MooreTable& moore)
+{
+    loadBinary(fileName, moore, AutomatonKind::Moore);
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Automaton.h"
+
+// Двоичный формат автомата (все числа little-endian, секции выровнены на 8 байт):
+//   BinaryHeader
+//   три таблицы имён (состояния, входы, выходы): uint32 count, uint32 offsets[count + 1], байты имён
+//   next: uint32[stateCount * inputCount]
+//   out:  uint32[stateCount * inputCount] для автомата Мили или uint32[stateCount] для автомата Мура
+// Загрузка отображает файл в память, проверяет заголовок и границы секций
+// и копирует массивы целиком, без разбора отдельных ячеек.
+
+constexpr char BINARY_MAGIC[4] = { 'A', 'U', 'T', 'M' };
+constexpr uint32_t BINARY_VERSION = 1;
+constexpr uint32_t BINARY_BYTE_ORDER = 0x01020304;
+const std::string BINARY_EXTENSION = ".bin";
+
+enum class AutomatonKind : uint32_t
+{
+    Mealy = 1,
+    Moore = 2,
+};
+
+struct BinaryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    AutomatonKind kind;
+    uint32_t stateCount;
+    uint32_t inputCount;
+    uint32_t outputCount;
+    uint32_t reserved;
+    uint64_t stateNamesOffset;
+    uint64_t inputNamesOffset;
+    uint64_t outputNamesOffset;
+    uint64_t nextOffset;
+    uint64_t outOffset;
+    uint64_t fileSize;
+};
+
+enum class FileFormat
+{
+    Csv,
+    Binary,
+    // Сгенерированный исходник C++ (только для записи, см. CodeGenerator.h).
+    Cpp,
+};
+
+// Формат по значению опции ("csv", "bin" или "cpp"), а если она пуста — по расширению
+// файла: .bin — двоичный, .cpp, .h и .hpp — исходник C++, остальные — CSV.
+FileFormat resolveFormat(const std::string& fileName, const std::string& option);
+
+void saveMealyBinary(const std::string& fileName, const MealyTable& mealy);
+void loadMealyBinary(const std::string& fileName, MealyTable& mealy);
+void saveMooreBinary(const std::string& fileName, const MooreTable& moore);
+void loadMooreBinary(const std::string& fileName, MooreTable& moore);
@@ -0,0 +1,474 @@
+﻿#include "CodeGenerator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "OutputFile.h"
+
+using namespace std;
+
+namespace
+{
+    // CodeStyle::Auto выбирает switch, если переходов не больше этого числа.
+    constexpr size_t SWITCH_TRANSITIONS = 256;
+    // Значений в одной строке массива.
+    constexpr size_t VALUES_PER_LINE = 16;
+
+    // Наименьший беззнаковый тип, вмещающий значения 0..maxValue.
+    const char* smallestType(uint64_t maxValue)
+    {
+        if (maxValue <= 0xFF) return "std::uint8_t";
+        if (maxValue <= 0xFFFF) return "std::uint16_t";
+        if (maxValue <= 0xFFFFFFFF) return "std::uint32_t";
+        return "std::uint64_t";
+    }
+
+    uint64_t typeMax(uint64_t maxValue)
+    {
+        if (maxValue <= 0xFF) return 0xFF;
+        if (maxValue <= 0xFFFF) return 0xFFFF;
+        return 0xFFFFFFFF;
+    }
+
+    string quote(const string& text)
+    {
+        string result = "\"";
+        for (unsigned char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result += '\\';
+                result += char(c);
+            }
+            else if (c < 0x20 || c == 0x7F)
+            {
+                // Восьмеричная запись не продолжается следующими символами, в отличие от \x.
+                const char digits[] = { '\\', char('0' + (c >> 6)), char('0' + ((c >> 3) & 7)), char('0' + (c & 7)), 0 };
+                result += digits;
+            }
+            else
+            {
+                result += char(c);
+            }
+        }
+        return result + "\"";
+    }
+
+    template <typename Value, typename Format>
+    void writeArray(ostream& output, const string& declaration, const vector<Value>& values, Format format)
+    {
+        output << "    " << declaration << " =\n    {";
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            output << (i % VALUES_PER_LINE == 0 ? "\n        " : " ") << format(values[i])
+                << (i + 1 < values.size() ? "," : "");
+        }
+        output << "\n    };\n";
+    }
+
+    void writeNames(ostream& output, const string& arrayName, const NameTable& names)
+    {
+        if (names.size() == 0)
+        {
+            return;
+        }
+        writeArray(output, "constexpr const char* " + arrayName + "[]", names.names,
+            [](const string& name) { return quote(name); });
+    }
+
+    // Общее представление для обоих видов автоматов: у автомата Мура выход перехода —
+    // выход состояния, в которое он ведёт.
+    struct Machine
+    {
+        const char* kind;
+        size_t stateCount;
+        size_t inputCount;
+        const NameTable* states;
+        const NameTable* inputs;
+        const NameTable* outputs;
+        const vector<StateId>* next;
+        // Выходы переходов (автомат Мили) или состояний (автомат Мура).
+        const vector<SymbolId>* out;
+        bool moore;
+
+        SymbolId transitionOutput(size_t transition) const
+        {
+            StateId target = (*next)[transition];
+            if (target == NO_STATE)
+            {
+                return 0;
+            }
+            return moore ? (*out)[target] : (*out)[transition];
+        }
+    };
+
+    void writeTables(ostream& output, const Machine& machine, uint64_t undefined)
+    {
+        vector<uint64_t> next(machine.next->size());
+        for (size_t i = 0; i < next.size(); i++)
+        {
+            StateId target = (*machine.next)[i];
+            next[i] = target == NO_STATE ? undefined : target;
+        }
+        auto number = [](uint64_t value) { return to_string(value); };
+
+        if (machine.moore)
+        {
+            writeArray(output, "constexpr State NEXT[STATE_COUNT * INPUT_COUNT]", next, number);
+            vector<uint64_t> stateOutput(machine.out->begin(), machine.out->end());
+            writeArray(output, "constexpr Output STATE_OUTPUT[STATE_COUNT]", stateOutput, number);
+            output << "\n"
+                << "    constexpr bool step(State& state, Input input, Output& output)\n"
+                << "    {\n"
+                << "        if (state >= STATE_COUNT || input >= INPUT_COUNT) return false;\n"
+                << "        State target = NEXT[std::size_t(state) * INPUT_COUNT + input];\n"
+                << "        if (target == UNDEFINED) return false;\n"
+                << "        state = target;\n"
+                << "        output = STATE_OUTPUT[target];\n"
+                << "        return true;\n"
+                << "    }\n";
+            return;
+        }
+
+        // Переход и его выход лежат рядом, чтобы шаг читал одну ячейку.
+        output << "    struct Transition\n    {\n        State next;\n        Output output;\n    };\n\n";
+        vector<size_t> transitions(next.size());
+        for (size_t i = 0; i < transitions.size(); i++)
+        {
+            transitions[i] = i;
+        }
+        writeArray(output, "constexpr Transition TRANSITIONS[STATE_COUNT * INPUT_COUNT]", transitions,
+            [&](size_t i) { return "{ " + to_string(next[i]) + ", " + to_string(machine.transitionOutput(i)) + " }"; });
+        output << "\n"
+            << "    constexpr bool step(State& state, Input input, Output& output)\n"
+            << "    {\n"
+            << "        if (state >= STATE_COUNT || input >= INPUT_COUNT) return false;\n"
+            << "        const Transition& transition = TRANSITIONS[std::size_t(state) * INPUT_COUNT + input];\n"
+            << "        if (transition.next == UNDEFINED) return false;\n"
+            << "        state = transition.next;\n"
+            << "        output = transition.output;\n"
+            << "        return true;\n"
+            << "    }\n";
+    }
+
+    void writeConstexprMachine(ostream& output, const Machine& machine, uint64_t undefined)
+    {
+        vector<uint64_t> next(machine.next->size());
+        for (size_t i = 0; i < next.size(); i++)
+        {
+            StateId target = (*machine.next)[i];
+            next[i] = target == NO_STATE ? undefined : target;
+        }
+        auto number = [](uint64_t value) { return to_string(value); };
+
+        writeArray(output, "constexpr std::array<Index, STATE_COUNT * INPUT_COUNT> NEXT", next, number);
+        if (machine.moore)
+        {
+            vector<uint64_t> stateOutput(machine.out->begin(), machine.out->end());
+            writeArray(output, "constexpr std::array<Index, STATE_COUNT> OUTPUT", stateOutput, number);
+        }
+        else
+        {
+            vector<uint64_t> transitionOutput(next.size());
+            for (size_t i = 0; i < next.size(); i++)
+            {
+                transitionOutput[i] = machine.transitionOutput(i);
+            }
+            writeArray(output, "constexpr std::array<Index, STATE_COUNT * INPUT_COUNT> OUTPUT", transitionOutput, number);
+        }
+        output << "\n"
+            << "    constexpr " << (machine.moore ? "ConstexprMoore" : "ConstexprMealy")
+            << "<STATE_COUNT, INPUT_COUNT, Index> MACHINE{ NEXT, OUTPUT, STATE_COUNT };\n"
+            << "\n"
+            << "    constexpr bool step(State& state, Input input, Output& output)\n"
+            << "    {\n"
+            << "        return MACHINE.step(state, input, output);\n"
+            << "    }\n";
+    }
+
+    void writeSwitch(ostream& output, const Machine& machine)
+    {
+        output << "    constexpr bool step(State& state, Input input, Output& output)\n"
+            << "    {\n";
+        // Без определённых переходов output не присваивается, а -Wunused-parameter
+        // не должен срабатывать на сгенерированном коде.
+        bool anyDefined = any_of(machine.next->begin(), machine.next->end(),
+            [](StateId target) { return target != NO_STATE; });
+        if (!anyDefined)
+        {
+            output << "        (void)output;\n";
+        }
+        output << "        switch (state)\n"
+            << "        {\n";
+        for (size_t s = 0; s < machine.stateCount; s++)
+        {
+            output << "        case " << s << ":\n"
+                << "            switch (input)\n"
+                << "            {\n";
+            for (size_t i = 0; i < machine.inputCount; i++)
+            {
+                size_t transition = s * machine.inputCount + i;
+                StateId target = (*machine.next)[transition];
+                if (target != NO_STATE)
+                {
+                    output << "            case " << i << ": state = " << target << "; output = "
+                        << machine.transitionOutput(transition) << "; return true;\n";
+                }
+            }
+            output << "            default: return false;\n"
+                << "            }\n";
+        }
+        output << "        default:\n"
+            << "            return false;\n"
+            << "        }\n"
+            << "    }\n";
+    }
+
+    void writeSelfTest(ostream& output, const Machine& machine, const CodeGenOptions& options)
+    {
+        size_t transitionCount = machine.stateCount * machine.inputCount;
+        if (transitionCount == 0 || options.testVectors == 0 || options.testLength == 0)
+        {
+            output << "\n    constexpr bool selfTest()\n    {\n        return true;\n    }\n";
+            return;
+        }
+
+        // Ожидаемые выходы считаются прямо по таблице, из которой генерировался код.
+        mt19937_64 random(options.seed);
+        vector<uint64_t> inputs(options.testVectors * options.testLength);
+        vector<uint64_t> outputs(inputs.size(), 0);
+        vector<uint64_t> steps(options.testVectors, 0);
+        for (size_t v = 0; v < options.testVectors; v++)
+        {
+            StateId state = 0;
+            bool stopped = false;
+            for (size_t i = 0; i < options.testLength; i++)
+            {
+                size_t position = v * options.testLength + i;
+                inputs[position] = random() % machine.inputCount;
+                if (stopped)
+                {
+                    continue;
+                }
+                size_t transition = size_t(state) * machine.inputCount + inputs[position];
+                StateId target = (*machine.next)[transition];
+                if (target == NO_STATE)
+                {
+                    stopped = true;
+                    continue;
+                }
+                outputs[position] = machine.transitionOutput(transition);
+                state = target;
+                steps[v]++;
+            }
+        }
+
+        auto number = [](uint64_t value) { return to_string(value); };
+        output << "\n"
+            << "    // Проверочные последовательности по исходной таблице: входы, ожидаемые выходы\n"
+            << "    // и число шагов до первого неопределённого перехода.\n"
+            << "    constexpr std::size_t TEST_COUNT = " << options.testVectors << ";\n"
+            << "    constexpr std::size_t TEST_LENGTH = " << options.testLength << ";\n";
+        writeArray(output, "constexpr Input TEST_INPUTS[TEST_COUNT * TEST_LENGTH]", inputs, number);
+        writeArray(output, "constexpr Output TEST_OUTPUTS[TEST_COUNT * TEST_LENGTH]", outputs, number);
+        writeArray(output, string("constexpr ") + smallestType(options.testLength) + " TEST_STEPS[TEST_COUNT]",
+            steps, number);
+        output << "\n"
+            << "    constexpr bool selfTest()\n"
+            << "    {\n"
+            << "        for (std::size_t v = 0; v < TEST_COUNT; v++)\n"
+            << "        {\n"
+            << "            Output outputs[TEST_LENGTH] = {};\n"
+            << "            std::size_t steps = run(TEST_INPUTS + v * TEST_LENGTH, TEST_LENGTH, outputs);\n"
+            << "            if (steps != TEST_STEPS[v]) return false;\n"
+            << "            for (std::size_t i = 0; i < steps; i++)\n"
+            << "            {\n"
+            << "                if (outputs[i] != TEST_OUTPUTS[v * TEST_LENGTH + i]) return false;\n"
+            << "            }\n"
+            << "        }\n"
+            << "        return true;\n"
+            << "    }\n";
+    }
+
+    void writeCpp(ostream& output, const Machine& machine, const CodeGenOptions& options)
+    {
+        string name = codeIdentifier(options.name);
+        string macro;
+        for (char c : name)
+        {
+            macro += char(toupper(static_cast<unsigned char>(c)));
+        }
+
+        size_t transitionCount = machine.stateCount * machine.inputCount;
+        CodeStyle style = options.style;
+        if (style == CodeStyle::Auto)
+        {
+            style = transitionCount <= SWITCH_TRANSITIONS ? CodeStyle::Switch : CodeStyle::Table;
+        }
+        // Номер UNDEFINED должен помещаться в тип State рядом с номерами состояний.
+        // В constexpr-варианте все номера одного типа Index, как у ConstexprMealy и ConstexprMoore.
+        uint64_t stateMax = machine.stateCount;
+        uint64_t inputMax = machine.inputCount == 0 ? 0 : machine.inputCount - 1;
+        uint64_t outputMax = machine.outputs->size() == 0 ? 0 : machine.outputs->size() - 1;
+        bool constexprStyle = style == CodeStyle::Constexpr && transitionCount != 0;
+        if (constexprStyle)
+        {
+            stateMax = inputMax = outputMax = max({ stateMax, inputMax, outputMax });
+        }
+        uint64_t undefined = typeMax(stateMax);
+
+        output << "// Автомат " << machine.kind << ": состояний " << machine.stateCount << ", входов "
+            << machine.inputCount << ", выходов " << machine.outputs->size() << ".\n"
+            << "// Сгенерировано Minimize; при изменении автомата сгенерируйте заново.\n"
+            << "#ifndef " << macro << "_AUTOMATON_INCLUDED\n"
+            << "#define " << macro << "_AUTOMATON_INCLUDED\n"
+            << "\n"
+            << "#include <cstddef>\n"
+            << "#include <cstdint>\n"
+            << (constexprStyle ? "\n#include \"ConstexprAutomaton.h\"\n" : "")
+            << "\n"
+            << "namespace " << name << "\n"
+            << "{\n";
+        if (constexprStyle)
+        {
+            output << "    using Index = " << smallestType(stateMax) << ";\n"
+                << "    using State = Index;\n"
+                << "    using Input = Index;\n"
+                << "    using Output = Index;\n";
+        }
+        else
+        {
+            output << "    using State = " << smallestType(stateMax) << ";\n"
+                << "    using Input = " << smallestType(inputMax) << ";\n"
+                << "    using Output = " << smallestType(outputMax) << ";\n";
+        }
+        output << "\n"
+            << "    constexpr std::size_t STATE_COUNT = " << machine.stateCount << ";\n"
+            << "    constexpr std::size_t INPUT_COUNT = " << machine.inputCount << ";\n"
+            << "    constexpr std::size_t OUTPUT_COUNT = " << machine.outputs->size() << ";\n"
+            << "    constexpr State START = 0;\n"
+            << "    constexpr State UNDEFINED = " << undefined << ";\n"
+            << "\n";
+        writeNames(output, "STATE_NAMES", *machine.states);
+        writeNames(output, "INPUT_NAMES", *machine.inputs);
+        writeNames(output, "OUTPUT_NAMES", *machine.outputs);
+        output << "\n"
+            << "    // Шаг из state по input. Если переход не определён, возвращает false\n"
+            << "    // и не меняет ни state, ни output.\n";
+
+        if (constexprStyle)
+        {
+            writeConstexprMachine(output, machine, undefined);
+        }
+        else if (transitionCount == 0)
+        {
+            output << "    constexpr bool step(State&, Input, Output&)\n    {\n        return false;\n    }\n";
+        }
+        else if (style == CodeStyle::Switch)
+        {
+            writeSwitch(output, machine);
+        }
+        else
+        {
+            writeTables(output, machine, undefined);
+        }
+
+        output << "\n"
+            << "    // Прогон с начального состояния; возвращает число выполненных шагов.\n"
+            << "    constexpr std::size_t run(const Input* inputs, std::size_t count, Output* outputs)\n"
+            << "    {\n"
+            << "        State state = START;\n"
+            << "        std::size_t i = 0;\n"
+            << "        while (i < count && step(state, inputs[i], outputs[i]))\n"
+            << "        {\n"
+            << "            i++;\n"
+            << "        }\n"
+            << "        return i;\n"
+            << "    }\n";
+        writeSelfTest(output, machine, options);
+        output << "}\n"
+            << "\n"
+            << "#ifdef " << macro << "_SELF_TEST\n"
+            << "int main()\n"
+            << "{\n"
+            << "    return " << name << "::selfTest() ? 0 : 1;\n"
+            << "}\n"
+            << "#endif\n"
+            << "\n"
+            << "#endif\n";
+    }
+
+    template <typename Write>
+    void saveCpp(const string& fileName, Write write)
+    {
+        OutputFile output(fileName, ios::binary);
+        if (!output.is_open())
+        {
+            throw runtime_error("Failed to open " + fileName + " for writing");
+        }
+        write(output.stream());
+        if (!output.commit())
+        {
+            throw runtime_error("Failed to write " + fileName);
+        }
+    }
+}
+
+CodeStyle parseCodeStyle(const string& value)
+{
+    if (value.empty() || value == "auto") return CodeStyle::Auto;
+    if (value == "table") return CodeStyle::Table;
+    if (value == "switch") return CodeStyle::Switch;
+    if (value == "constexpr") return CodeStyle::Constexpr;
+    throw runtime_error("Unknown code style " + value);
+}
+
+string codeIdentifier(const string& text)
+{
+    string result;
+    for (char c : text)
+    {
+        result += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    if (result.empty() || isdigit(static_cast<unsigned char>(result[0])))
+    {
+        result = "Automaton" + result;
+    }
+    return result;
+}
+
+string codeNameFromFile(const string& fileName)
+{
+    size_t begin = fileName.find_last_of("/\\");
+    begin = begin == string::npos ? 0 : begin + 1;
+    size_t end = fileName.find('.', begin);
+    return codeIdentifier(fileName.substr(begin, end == string::npos ? string::npos : end - begin));
+}
+
+void writeMealyCpp(ostream& output, const MealyTable& mealy, const CodeGenOptions& options)
+{
+    Machine machine{ "Мили", mealy.stateCount(), mealy.inputCount(), &mealy.states, &mealy.inputs,
+        &mealy.outputs, &mealy.next, &mealy.out, false };
+    writeCpp(output, machine, options);
+}
+
+void writeMooreCpp(ostream& output, const MooreTable& moore, const CodeGenOptions& options)
+{
+    Machine machine{ "Мура", moore.stateCount(), moore.inputCount(), &moore.states, &moore.inputs,
+        &moore.outputs, &moore.next, &moore.out, true };
+    writeCpp(output, machine, options);
+}
+
+void saveMealyCpp(const string& fileName, const MealyTable& mealy, const CodeGenOptions& options)
+{
+    saveCpp(fileName, [&](ostream& output) { writeMealyCpp(output, mealy, options); });
+}
+
+void saveMooreCpp(const string& fileName, const MooreTable& moore, const CodeGenOptions& options)
+{
+    saveCpp(fileName, [&](ostream& output) { writeMooreCpp(output, moore, options); });
+}
@@ -0,0 +1,48 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "Automaton.h"
+
+// Генерация самодостаточного исходника C++ по (минимизированному) автомату.
+// Исходник объявляет в пространстве имён options.name функции step, run и selfTest
+// с таблицами наименьших подходящих целочисленных типов. Его можно включать как
+// заголовок; с -D<NAME>_SELF_TEST он собирается в программу, проверяющую себя на
+// сгенерированных последовательностях, выходы которых посчитаны по исходной таблице.
+
+enum class CodeStyle
+{
+    // Switch для маленьких автоматов, таблицы для остальных.
+    Auto,
+    // Упакованные constexpr-таблицы переходов и выходов.
+    Table,
+    // Вложенные switch по состоянию и входу.
+    Switch,
+    // Таблица в шаблоне ConstexprMealy/ConstexprMoore; исходник включает ConstexprAutomaton.h.
+    Constexpr,
+};
+
+struct CodeGenOptions
+{
+    std::string name = "Automaton";
+    CodeStyle style = CodeStyle::Auto;
+    size_t testVectors = 32;
+    size_t testLength = 16;
+    uint64_t seed = 1;
+};
+
+// Разбор значения опции --code-style (auto, table, switch, constexpr).
+CodeStyle parseCodeStyle(const std::string& value);
+// Идентификатор C++ из произвольной строки, например имени файла.
+std::string codeIdentifier(const std::string& text);
+// Имя пространства имён по умолчанию: имя файла без каталога и расширения.
+std::string codeNameFromFile(const std::string& fileName);
+
+void writeMealyCpp(std::ostream& output, const MealyTable& mealy, const CodeGenOptions& options);
+void writeMooreCpp(std::ostream& output, const MooreTable& moore, const CodeGenOptions& options);
+
+// То же с открытием файла; при ошибке бросается std::runtime_error.
+void saveMealyCpp(const std::string& fileName, const MealyTable& mealy, const CodeGenOptions& options);
+void saveMooreCpp(const std::string& fileName, const MooreTable& moore, const CodeGenOptions& options);
@@ -0,0 +1,34 @@
+﻿#include "CommandLine.h"
+
+using namespace std;
+
+string CommandLine::option(const string& name, const string& defaultValue) const
+{
+    auto it = options.find(name);
+    return it == options.end() ? defaultValue : it->second;
+}
+
+CommandLine parseCommandLine(int argc, char* argv[])
+{
+    CommandLine commandLine;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.rfind("--", 0) != 0)
+        {
+            commandLine.args.push_back(arg);
+            continue;
+        }
+
+        size_t equals = arg.find('=');
+        if (equals == string::npos)
+        {
+            commandLine.options[arg.substr(2)] = "";
+        }
+        else
+        {
+            commandLine.options[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+        }
+    }
+    return commandLine;
+}
@@ -0,0 +1,16 @@
+﻿#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+// Аргументы командной строки: позиционные и опции вида --name=value или --name.
+struct CommandLine
+{
+    std::vector<std::string> args;
+    std::map<std::string, std::string> options;
+
+    bool has(const std::string& name) const { return options.count(name) != 0; }
+    std::string option(const std::string& name, const std::string& defaultValue = "") const;
+};
+
+CommandLine parseCommandLine(int argc, char* argv[]);
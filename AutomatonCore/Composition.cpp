@@ -0,0 +1,160 @@
+﻿#include "Composition.h"
+#include "PairIndex.h"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    void appendEscaped(string& result, const string& name)
+    {
+        for (char c : name)
+        {
+            if (c == ',' || c == '\\')
+            {
+                result += '\\';
+            }
+            result += c;
+        }
+    }
+
+    // Имя пары "p,q": запятая и обратная косая черта в частях экранируются, поэтому
+    // разные пары не получают одно имя ("a,b" и "c" дают "a\,b,c", "a" и "b,c" — "a,b\,c").
+    string pairName(const string& first, const string& second)
+    {
+        string result;
+        appendEscaped(result, first);
+        result += ',';
+        appendEscaped(result, second);
+        return result;
+    }
+
+    // Обход пар от (0, 0). step(p, q, input, target, output) задаёт переход пары:
+    // возвращает false для неопределённого перехода, иначе заполняет пару-цель
+    // и номер выхода в result.outputs.
+    template <typename Step>
+    void buildReachablePairs(const MealyTable& first, const MealyTable& second, MealyTable& result, const Step& step)
+    {
+        if (first.stateCount() == 0 || second.stateCount() == 0)
+        {
+            throw runtime_error("Empty automaton.");
+        }
+
+        size_t inputCount = result.inputCount();
+        PairIndex index(max(first.stateCount(), second.stateCount()));
+        vector<pair<StateId, StateId>> pairs = { { 0, 0 } };
+        index.insert(0, 0, 0);
+
+        for (size_t head = 0; head < pairs.size(); head++)
+        {
+            for (size_t j = 0; j < inputCount; j++)
+            {
+                pair<StateId, StateId> target;
+                SymbolId output = 0;
+                if (!step(pairs[head].first, pairs[head].second, j, target, output))
+                {
+                    result.next.push_back(NO_STATE);
+                    result.out.push_back(result.outputs.intern(UNDEFINED_NAME));
+                    continue;
+                }
+                auto inserted = index.insert(target.first, target.second, StateId(pairs.size()));
+                if (inserted.second)
+                {
+                    pairs.push_back(target);
+                }
+                result.next.push_back(inserted.first);
+                result.out.push_back(output);
+            }
+        }
+
+        result.states.names.reserve(pairs.size());
+        result.states.ids.reserve(pairs.size());
+        for (const auto& state : pairs)
+        {
+            // Совпасть имена могут, только если они повторяются в исходных автоматах.
+            string name = pairName(first.states[state.first], second.states[state.second]);
+            while (result.states.find(name) != NO_STATE)
+            {
+                name += '\'';
+            }
+            result.states.add(name);
+        }
+    }
+}
+
+MealyTable productMealy(const MealyTable& first, const MealyTable& second)
+{
+    MealyTable product;
+    vector<pair<SymbolId, SymbolId>> inputs;
+    for (size_t a = 0; a < first.inputCount(); a++)
+    {
+        SymbolId b = second.inputs.find(first.inputs[uint32_t(a)]);
+        if (b != NO_STATE)
+        {
+            inputs.emplace_back(SymbolId(a), b);
+            product.inputs.add(first.inputs[uint32_t(a)]);
+        }
+    }
+
+    // Номер выхода пары (y1, y2) в product.outputs.
+    PairIndex outputs(16);
+    buildReachablePairs(first, second, product, [&](StateId p, StateId q, size_t input,
+        pair<StateId, StateId>& target, SymbolId& output)
+    {
+        size_t transition1 = size_t(p) * first.inputCount() + inputs[input].first;
+        size_t transition2 = size_t(q) * second.inputCount() + inputs[input].second;
+        target = { first.next[transition1], second.next[transition2] };
+        if (target.first == NO_STATE || target.second == NO_STATE)
+        {
+            return false;
+        }
+        SymbolId y1 = first.out[transition1];
+        SymbolId y2 = second.out[transition2];
+        auto inserted = outputs.insert(y1, y2, SymbolId(product.outputs.size()));
+        if (inserted.second)
+        {
+            product.outputs.intern(pairName(first.outputs[y1], second.outputs[y2]));
+        }
+        output = inserted.first;
+        return true;
+    });
+    return product;
+}
+
+MealyTable cascadeMealy(const MealyTable& first, const MealyTable& second)
+{
+    MealyTable cascade;
+    cascade.inputs = first.inputs;
+    cascade.outputs = second.outputs;
+
+    // Вход second для каждого выхода first.
+    vector<SymbolId> feed(first.outputs.size());
+    for (size_t y = 0; y < first.outputs.size(); y++)
+    {
+        feed[y] = second.inputs.find(first.outputs[uint32_t(y)]);
+    }
+
+    buildReachablePairs(first, second, cascade, [&](StateId p, StateId q, size_t input,
+        pair<StateId, StateId>& target, SymbolId& output)
+    {
+        size_t transition1 = size_t(p) * first.inputCount() + input;
+        StateId p2 = first.next[transition1];
+        SymbolId a = feed[first.out[transition1]];
+        if (p2 == NO_STATE || a == NO_STATE)
+        {
+            return false;
+        }
+        size_t transition2 = size_t(q) * second.inputCount() + a;
+        if (second.next[transition2] == NO_STATE)
+        {
+            return false;
+        }
+        target = { p2, second.next[transition2] };
+        output = second.out[transition2];
+        return true;
+    });
+    return cascade;
+}
@@ -0,0 +1,18 @@
+﻿#pragma once
+#include "Automaton.h"
+
+// Композиция автоматов Мили. Строится только достижимая из пары начальных
+// состояний часть произведения: пары нумеруются по мере обхода в ширину, и
+// работа пропорциональна числу достижимых пар, а не произведению n1·n2.
+// Состояние результата называется "p,q" по именам состояний исходных автоматов;
+// запятая и "\" в этих именах экранируются "\", так что имена пар не совпадают.
+
+// Синхронное произведение: оба автомата читают один и тот же вход. Входы —
+// общие для обоих (в порядке first), выход перехода — "y1,y2". Переход
+// определён, если он определён в обоих автоматах.
+MealyTable productMealy(const MealyTable& first, const MealyTable& second);
+
+// Каскад: выход first подаётся на вход second (сопоставление по имени).
+// Входы — входы first, выходы — выходы second. Переход не определён, если он
+// не определён в одном из автоматов или выхода first нет среди входов second.
+MealyTable cascadeMealy(const MealyTable& first, const MealyTable& second);
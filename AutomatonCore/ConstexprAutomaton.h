@@ -0,0 +1,316 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Автоматы фиксированного размера, которые целиком живут во время компиляции:
+// таблицу можно заполнить сгенерированными данными (Minimize --code-style=constexpr),
+// минимизировать и прогнать в constexpr-контексте и проверить static_assert.
+// Минимизация повторяет Minimize: отсечение недостижимых из состояния 0, начальное
+// разбиение по выходам и набору определённых переходов, раунды разделения по блокам
+// преемников и нумерация блоков в порядке обхода в ширину. Поэтому номера состояний
+// результата совпадают с номерами q0, q1, ... в выводе Minimize.
+//
+// Состояния, входы и выходы — номера типа Index; наибольшее значение Index
+// обозначает неопределённый переход. После minimize используются только первые
+// stateCount состояний; shrink<N>() переносит их в автомат ёмкостью N.
+
+namespace ConstexprAutomatonDetail
+{
+    // Блок каждого состояния (UNDEFINED для недостижимых) и число блоков.
+    template <std::size_t States, typename Index>
+    struct Partition
+    {
+        std::array<Index, States> blocks{};
+        std::array<Index, States> representatives{};
+        std::size_t count = 0;
+    };
+
+    // sameOutputs(p, q) сравнивает выходы состояний; next — переходы states × Inputs.
+    template <std::size_t States, std::size_t Inputs, typename Index, typename SameOutputs>
+    constexpr Partition<States, Index> minimizeBlocks(const std::array<Index, States * Inputs>& next,
+        std::size_t stateCount, SameOutputs sameOutputs)
+    {
+        constexpr Index UNDEFINED = std::numeric_limits<Index>::max();
+        Partition<States, Index> partition;
+        for (auto& block : partition.blocks)
+        {
+            block = UNDEFINED;
+        }
+        if (stateCount == 0)
+        {
+            return partition;
+        }
+
+        // Достижимые состояния в порядке обхода в ширину.
+        std::array<Index, States> order{};
+        std::array<bool, States> visited{};
+        std::size_t reachable = 1;
+        order[0] = 0;
+        visited[0] = true;
+        for (std::size_t head = 0; head < reachable; head++)
+        {
+            for (std::size_t a = 0; a < Inputs; a++)
+            {
+                Index t = next[std::size_t(order[head]) * Inputs + a];
+                if (t != UNDEFINED && !visited[t])
+                {
+                    visited[t] = true;
+                    order[reachable++] = t;
+                }
+            }
+        }
+
+        auto sameDefined = [&](Index p, Index q)
+        {
+            for (std::size_t a = 0; a < Inputs; a++)
+            {
+                if ((next[std::size_t(p) * Inputs + a] == UNDEFINED) != (next[std::size_t(q) * Inputs + a] == UNDEFINED))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Начальное разбиение: класс представлен первым состоянием с теми же выходами.
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < reachable; i++)
+        {
+            Index p = order[i];
+            std::size_t block = 0;
+            while (block < count && !(sameOutputs(partition.representatives[block], p)
+                && sameDefined(partition.representatives[block], p)))
+            {
+                block++;
+            }
+            if (block == count)
+            {
+                partition.representatives[count++] = p;
+            }
+            partition.blocks[p] = Index(block);
+        }
+
+        // Раунды: состояние остаётся с представителем, если совпадают их блоки и блоки преемников.
+        while (true)
+        {
+            Partition<States, Index> refined;
+            std::size_t refinedCount = 0;
+            for (std::size_t i = 0; i < reachable; i++)
+            {
+                Index p = order[i];
+                std::size_t block = 0;
+                for (; block < refinedCount; block++)
+                {
+                    Index q = refined.representatives[block];
+                    bool same = partition.blocks[p] == partition.blocks[q];
+                    for (std::size_t a = 0; a < Inputs && same; a++)
+                    {
+                        Index tp = next[std::size_t(p) * Inputs + a];
+                        Index tq = next[std::size_t(q) * Inputs + a];
+                        same = (tp == UNDEFINED ? UNDEFINED : partition.blocks[tp])
+                            == (tq == UNDEFINED ? UNDEFINED : partition.blocks[tq]);
+                    }
+                    if (same)
+                    {
+                        break;
+                    }
+                }
+                if (block == refinedCount)
+                {
+                    refined.representatives[refinedCount++] = p;
+                }
+                refined.blocks[p] = Index(block);
+            }
+
+            for (std::size_t s = 0; s < States; s++)
+            {
+                partition.blocks[s] = s < stateCount && visited[s] ? refined.blocks[s] : UNDEFINED;
+            }
+            partition.representatives = refined.representatives;
+            if (refinedCount == count)
+            {
+                break;
+            }
+            count = refinedCount;
+        }
+
+        partition.count = count;
+        return partition;
+    }
+}
+
+template <std::size_t States, std::size_t Inputs, typename Index = std::uint8_t>
+struct ConstexprMealy
+{
+    static_assert(std::is_unsigned_v<Index>, "Index must be an unsigned integer type");
+    static_assert(States <= std::numeric_limits<Index>::max(), "Index is too small for the state count");
+    static_assert(Inputs <= std::size_t(std::numeric_limits<Index>::max()) + 1, "Index is too small for the alphabet");
+
+    static constexpr Index UNDEFINED = std::numeric_limits<Index>::max();
+
+    // next[state * Inputs + input] и выход того же перехода.
+    std::array<Index, States * Inputs> next{};
+    std::array<Index, States * Inputs> out{};
+    std::size_t stateCount = States;
+
+    // Шаг из state по input. Если переход не определён, возвращает false
+    // и не меняет ни state, ни output.
+    constexpr bool step(Index& state, Index input, Index& output) const
+    {
+        if (state >= stateCount || input >= Inputs)
+        {
+            return false;
+        }
+        std::size_t transition = std::size_t(state) * Inputs + input;
+        if (next[transition] == UNDEFINED)
+        {
+            return false;
+        }
+        output = out[transition];
+        state = next[transition];
+        return true;
+    }
+
+    // Прогон из start; возвращает число выполненных шагов.
+    constexpr std::size_t run(const Index* inputs, std::size_t count, Index* outputs, Index start = 0) const
+    {
+        std::size_t i = 0;
+        while (i < count && step(start, inputs[i], outputs[i]))
+        {
+            i++;
+        }
+        return i;
+    }
+
+    constexpr ConstexprMealy minimize() const
+    {
+        auto sameOutputs = [this](Index p, Index q)
+        {
+            for (std::size_t a = 0; a < Inputs; a++)
+            {
+                if (out[std::size_t(p) * Inputs + a] != out[std::size_t(q) * Inputs + a])
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        auto partition = ConstexprAutomatonDetail::minimizeBlocks<States, Inputs, Index>(next, stateCount, sameOutputs);
+
+        ConstexprMealy result;
+        result.stateCount = partition.count;
+        for (std::size_t b = 0; b < States; b++)
+        {
+            for (std::size_t a = 0; a < Inputs; a++)
+            {
+                std::size_t transition = b * Inputs + a;
+                if (b >= partition.count)
+                {
+                    result.next[transition] = UNDEFINED;
+                    result.out[transition] = 0;
+                    continue;
+                }
+                std::size_t source = std::size_t(partition.representatives[b]) * Inputs + a;
+                result.next[transition] = next[source] == UNDEFINED ? UNDEFINED : partition.blocks[next[source]];
+                result.out[transition] = out[source];
+            }
+        }
+        return result;
+    }
+
+    // Первые NewStates состояний в автомате меньшей ёмкости, обычно shrink<m.stateCount>().
+    template <std::size_t NewStates>
+    constexpr ConstexprMealy<NewStates, Inputs, Index> shrink() const
+    {
+        ConstexprMealy<NewStates, Inputs, Index> result;
+        result.stateCount = NewStates < stateCount ? NewStates : stateCount;
+        for (std::size_t i = 0; i < NewStates * Inputs; i++)
+        {
+            result.next[i] = i < States * Inputs ? next[i] : UNDEFINED;
+            result.out[i] = i < States * Inputs ? out[i] : 0;
+        }
+        return result;
+    }
+};
+
+template <std::size_t States, std::size_t Inputs, typename Index = std::uint8_t>
+struct ConstexprMoore
+{
+    static_assert(std::is_unsigned_v<Index>, "Index must be an unsigned integer type");
+    static_assert(States <= std::numeric_limits<Index>::max(), "Index is too small for the state count");
+    static_assert(Inputs <= std::size_t(std::numeric_limits<Index>::max()) + 1, "Index is too small for the alphabet");
+
+    static constexpr Index UNDEFINED = std::numeric_limits<Index>::max();
+
+    // next[state * Inputs + input] и выход каждого состояния.
+    std::array<Index, States * Inputs> next{};
+    std::array<Index, States> out{};
+    std::size_t stateCount = States;
+
+    // Выходом шага считается выход состояния, в которое он ведёт.
+    constexpr bool step(Index& state, Index input, Index& output) const
+    {
+        if (state >= stateCount || input >= Inputs)
+        {
+            return false;
+        }
+        Index target = next[std::size_t(state) * Inputs + input];
+        if (target == UNDEFINED)
+        {
+            return false;
+        }
+        output = out[target];
+        state = target;
+        return true;
+    }
+
+    constexpr std::size_t run(const Index* inputs, std::size_t count, Index* outputs, Index start = 0) const
+    {
+        std::size_t i = 0;
+        while (i < count && step(start, inputs[i], outputs[i]))
+        {
+            i++;
+        }
+        return i;
+    }
+
+    constexpr ConstexprMoore minimize() const
+    {
+        auto sameOutputs = [this](Index p, Index q) { return out[p] == out[q]; };
+        auto partition = ConstexprAutomatonDetail::minimizeBlocks<States, Inputs, Index>(next, stateCount, sameOutputs);
+
+        ConstexprMoore result;
+        result.stateCount = partition.count;
+        for (std::size_t b = 0; b < States; b++)
+        {
+            Index representative = partition.representatives[b];
+            result.out[b] = b < partition.count ? out[representative] : 0;
+            for (std::size_t a = 0; a < Inputs; a++)
+            {
+                Index target = b < partition.count ? next[std::size_t(representative) * Inputs + a] : UNDEFINED;
+                result.next[b * Inputs + a] = target == UNDEFINED ? UNDEFINED : partition.blocks[target];
+            }
+        }
+        return result;
+    }
+
+    template <std::size_t NewStates>
+    constexpr ConstexprMoore<NewStates, Inputs, Index> shrink() const
+    {
+        ConstexprMoore<NewStates, Inputs, Index> result;
+        result.stateCount = NewStates < stateCount ? NewStates : stateCount;
+        for (std::size_t s = 0; s < NewStates; s++)
+        {
+            result.out[s] = s < States ? out[s] : 0;
+            for (std::size_t a = 0; a < Inputs; a++)
+            {
+                std::size_t i = s * Inputs + a;
+                result.next[i] = s < States ? next[i] : UNDEFINED;
+            }
+        }
+        return result;
+    }
+};
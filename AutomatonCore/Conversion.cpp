@@ -0,0 +1,104 @@
+﻿#include "Conversion.h"
+#include "Graph.h"
+#include "PairIndex.h"
+
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    // Выход начального состояния автомата Мура: наименьший по имени выход среди
+    // переходов в начальное состояние Мили из достижимых состояний, иначе пустой.
+    SymbolId startOutput(MealyTable& mealy, const vector<StateId>& reachable)
+    {
+        SymbolId best = NO_STATE;
+        size_t inputCount = mealy.inputCount();
+        for (auto state : reachable)
+        {
+            for (size_t j = 0; j < inputCount; j++)
+            {
+                size_t transition = size_t(state) * inputCount + j;
+                if (mealy.next[transition] == 0
+                    && (best == NO_STATE || mealy.outputs[mealy.out[transition]] < mealy.outputs[best]))
+                {
+                    best = mealy.out[transition];
+                }
+            }
+        }
+        return best == NO_STATE ? mealy.outputs.intern("") : best;
+    }
+}
+
+// Состояния автомата Мура — пары (состояние Мили, выход перехода в него). Пары
+// создаются обходом в ширину от начальной по мере их появления, поэтому строятся
+// только достижимые состояния, а работа линейна по размеру результата.
+MooreTable mealyToMoore(MealyTable& mealy, ThreadPool& pool)
+{
+    MooreTable moore;
+    if (mealy.stateCount() == 0)
+    {
+        moore.inputs = mealy.inputs;
+        moore.outputs = mealy.outputs;
+        return moore;
+    }
+
+    SymbolId firstOutput = startOutput(mealy, findReachable(mealy.next, mealy.stateCount(), mealy.inputCount(), pool));
+    moore.inputs = mealy.inputs;
+    moore.outputs = mealy.outputs;
+    size_t inputCount = mealy.inputCount();
+
+    PairIndex mooreStateIndex(mealy.stateCount());
+    vector<pair<StateId, SymbolId>> statesForMoore;
+    mooreStateIndex.insert(0, firstOutput, 0);
+    statesForMoore.emplace_back(StateId(0), firstOutput);
+    moore.next.reserve(mealy.next.size());
+
+    for (size_t head = 0; head < statesForMoore.size(); head++)
+    {
+        StateId mealyState = statesForMoore[head].first;
+        moore.out.push_back(statesForMoore[head].second);
+        for (size_t j = 0; j < inputCount; j++)
+        {
+            size_t transition = size_t(mealyState) * inputCount + j;
+            StateId target = mealy.next[transition];
+            if (target == NO_STATE)
+            {
+                moore.next.push_back(NO_STATE);
+                continue;
+            }
+            auto inserted = mooreStateIndex.insert(target, mealy.out[transition], StateId(statesForMoore.size()));
+            if (inserted.second)
+            {
+                statesForMoore.emplace_back(target, mealy.out[transition]);
+            }
+            moore.next.push_back(inserted.first);
+        }
+    }
+
+    moore.states.names.reserve(statesForMoore.size());
+    moore.states.ids.reserve(statesForMoore.size());
+    for (size_t i = 0; i < statesForMoore.size(); i++)
+    {
+        moore.states.add("q" + to_string(i));
+    }
+    return moore;
+}
+
+MealyTable mooreToMealy(const MooreTable& moore)
+{
+    MealyTable mealy;
+    mealy.states = moore.states;
+    mealy.inputs = moore.inputs;
+    mealy.outputs = moore.outputs;
+    mealy.next = moore.next;
+    mealy.out.resize(moore.next.size());
+
+    SymbolId undefinedOut = mealy.outputs.intern(UNDEFINED_NAME);
+    for (size_t i = 0; i < moore.next.size(); i++)
+    {
+        mealy.out[i] = moore.next[i] == NO_STATE ? undefinedOut : moore.output(moore.next[i]);
+    }
+    return mealy;
+}
@@ -0,0 +1,13 @@
+﻿#pragma once
+#include "Automaton.h"
+#include "ThreadPool.h"
+
+// Преобразования между автоматами Мили и Мура в памяти.
+
+// Состояния результата — пары (состояние Мили, выход перехода в него), q0 — начальная
+// пара. Строятся только пары, достижимые из начальной. В mealy.outputs может
+// добавиться пустой выход для начального состояния, в которое нет переходов.
+MooreTable mealyToMoore(MealyTable& mealy, ThreadPool& pool = ThreadPool::instance());
+
+// Выход перехода — выход состояния, в которое он ведёт; состояния сохраняются.
+MealyTable mooreToMealy(const MooreTable& moore);
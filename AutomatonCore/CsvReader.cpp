@@ -0,0 +1,577 @@
+﻿#include "CsvReader.h"
+#include "Diagnostics.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSV_SIMD_AVX2
+#define CSV_SIMD_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_SIMD_SSE2
+#endif
+
+using namespace std;
+
+const char* findEither(const char* begin, const char* end, char first, char second)
+{
+    const char* p = begin;
+
+#ifdef CSV_SIMD_AVX2
+    const __m256i first32 = _mm256_set1_epi8(first);
+    const __m256i second32 = _mm256_set1_epi8(second);
+    while (end - p >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, first32), _mm256_cmpeq_epi8(chunk, second32));
+        unsigned mask = unsigned(_mm256_movemask_epi8(hits));
+        if (mask != 0)
+        {
+            return p + countr_zero(mask);
+        }
+        p += 32;
+    }
+#endif
+
+#ifdef CSV_SIMD_SSE2
+    const __m128i first16 = _mm_set1_epi8(first);
+    const __m128i second16 = _mm_set1_epi8(second);
+    while (end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, first16), _mm_cmpeq_epi8(chunk, second16));
+        unsigned mask = unsigned(_mm_movemask_epi8(hits));
+        if (mask != 0)
+        {
+            return p + countr_zero(mask);
+        }
+        p += 16;
+    }
+#endif
+
+    while (p != end && *p != first && *p != second)
+    {
+        p++;
+    }
+    return p;
+}
+
+namespace
+{
+    const string_view UTF8_BOM = "\xEF\xBB\xBF";
+
+    const char* skipBlankLines(const char* p, const char* end)
+    {
+        while (p != end && (*p == '\n' || *p == '\r'))
+        {
+            p++;
+        }
+        return p;
+    }
+
+    // Вызывает onCell(index, cell) для каждой ячейки строки, начинающейся с p,
+    // и возвращает начало следующей строки.
+    template <typename OnCell>
+    const char* parseRow(const char* p, const char* end, OnCell&& onCell)
+    {
+        size_t index = 0;
+        while (true)
+        {
+            const char* delimiter = findEither(p, end, ';', '\n');
+            bool lastCell = delimiter == end || *delimiter == '\n';
+            const char* cellEnd = delimiter;
+            if (lastCell && cellEnd != p && cellEnd[-1] == '\r')
+            {
+                cellEnd--;
+            }
+
+            onCell(index++, string_view(p, size_t(cellEnd - p)));
+
+            if (delimiter == end)
+            {
+                return end;
+            }
+            p = delimiter + 1;
+            if (lastCell)
+            {
+                return p;
+            }
+        }
+    }
+
+    string_view withoutBom(string_view data)
+    {
+        if (data.substr(0, UTF8_BOM.size()) == UTF8_BOM)
+        {
+            data.remove_prefix(UTF8_BOM.size());
+        }
+        return data;
+    }
+
+    string_view orUndefined(string_view name)
+    {
+        return name.empty() ? string_view(UNDEFINED_NAME) : name;
+    }
+
+    // Непустая ячейка разреженной таблицы в порядке чтения файла (по строкам входов).
+    struct SparseCell
+    {
+        StateId state;
+        SymbolId input;
+        StateId next;
+        SymbolId out;
+    };
+
+    // Раскладывает ячейки по строкам состояний (CSR): place(position, cell) кладёт ячейку
+    // на её позицию. Внутри строки состояния ячейки остаются по возрастанию входа.
+    template <typename Place>
+    void distributeCells(size_t stateCount, const vector<SparseCell>& cells, vector<size_t>& offsets, Place&& place)
+    {
+        offsets.assign(stateCount + 1, 0);
+        for (const auto& cell : cells)
+        {
+            offsets[cell.state + 1]++;
+        }
+        for (size_t s = 1; s < offsets.size(); s++)
+        {
+            offsets[s] += offsets[s - 1];
+        }
+
+        vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const auto& cell : cells)
+        {
+            place(fill[cell.state]++, cell);
+        }
+    }
+
+    // Файлы меньше порога разбираются одним отрезком: выигрыш от потоков не окупает слияния.
+    constexpr size_t PARALLEL_PARSE_THRESHOLD = size_t(4) << 20;
+    // Отрезков больше, чем потоков, чтобы длинные строки не оставляли потоки без работы.
+    constexpr size_t CHUNKS_PER_THREAD = 4;
+    // Число состояний в одном отрезке перестановки строк в порядок хранения.
+    constexpr size_t TRANSPOSE_GRAIN = 4096;
+
+    // Строки входов из одного отрезка файла. Выходы интернируются в таблицу отрезка и
+    // получают общие номера при слиянии, сообщения об ошибках копятся в errors и печатаются
+    // в порядке файла. Поэтому результат и вывод не зависят от числа потоков.
+    struct RowChunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        vector<string_view> inputs;
+        NameTable outputs;
+        vector<StateId> next;
+        vector<SymbolId> out;
+        bool hasUndefinedOut = false;
+        ostringstream errors;
+    };
+
+    // Делит [p, end) примерно на parts равных частей по границам строк.
+    vector<RowChunk> splitRows(const char* p, const char* end, size_t parts)
+    {
+        vector<const char*> bounds{ p };
+        for (size_t i = 1; i < parts; i++)
+        {
+            const char* bound = max(bounds.back(), p + size_t(end - p) * i / parts);
+            const char* newline = static_cast<const char*>(memchr(bound, '\n', size_t(end - bound)));
+            if (newline == nullptr || newline + 1 == end)
+            {
+                break;
+            }
+            bounds.push_back(newline + 1);
+        }
+        bounds.push_back(end);
+
+        vector<RowChunk> chunks(bounds.size() - 1);
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            chunks[c].begin = bounds[c];
+            chunks[c].end = bounds[c + 1];
+        }
+        return chunks;
+    }
+
+    // Разбирает строки входов [p, end) функцией parseRows(chunk), на больших файлах —
+    // отдельными отрезками в пуле потоков, и печатает накопленные сообщения об ошибках.
+    template <typename ParseRows>
+    vector<RowChunk> parseRowChunks(const char* p, const char* end, ThreadPool& pool, ParseRows&& parseRows)
+    {
+        size_t parts = size_t(end - p) < PARALLEL_PARSE_THRESHOLD ? 1 : pool.concurrency() * CHUNKS_PER_THREAD;
+        vector<RowChunk> chunks = splitRows(p, end, parts);
+        pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t last)
+        {
+            for (size_t c = begin; c < last; c++)
+            {
+                parseRows(chunks[c]);
+            }
+        });
+        if (chunks.size() > 1)
+        {
+            recordCounter("parse_chunks", chunks.size());
+        }
+
+        for (const auto& chunk : chunks)
+        {
+            string errors = chunk.errors.str();
+            if (!errors.empty())
+            {
+                cerr << errors << flush;
+            }
+        }
+        return chunks;
+    }
+
+    // Переставляет строки отрезков в порядок хранения (по состояниям): store(chunk, cell, position)
+    // переносит ячейку cell строк отрезка chunk на позицию position общей таблицы.
+    template <typename Store>
+    void transposeChunks(const vector<RowChunk>& chunks, size_t stateCount, ThreadPool& pool, Store&& store)
+    {
+        vector<size_t> firstRow;
+        size_t inputCount = 0;
+        for (const auto& chunk : chunks)
+        {
+            firstRow.push_back(inputCount);
+            inputCount += chunk.inputs.size();
+        }
+
+        pool.parallelFor(stateCount, TRANSPOSE_GRAIN, [&](size_t begin, size_t end)
+        {
+            for (size_t c = 0; c < chunks.size(); c++)
+            {
+                for (size_t row = 0; row < chunks[c].inputs.size(); row++)
+                {
+                    for (size_t s = begin; s < end; s++)
+                    {
+                        store(c, row * stateCount + s, s * inputCount + firstRow[c] + row);
+                    }
+                }
+            }
+        });
+    }
+
+    void parseMealyRows(RowChunk& chunk, const NameTable& states)
+    {
+        size_t stateCount = states.size();
+        bool warn = logEnabled(Verbosity::Warning);
+        const char* p = chunk.begin;
+        while ((p = skipBlankLines(p, chunk.end)) != chunk.end)
+        {
+            size_t rowBegin = chunk.next.size();
+            chunk.next.resize(rowBegin + stateCount, NO_STATE);
+            chunk.out.resize(rowBegin + stateCount, NO_STATE);
+
+            size_t cellCount = 0;
+            p = parseRow(p, chunk.end, [&](size_t index, string_view cell)
+            {
+                cellCount = index + 1;
+                if (index == 0)
+                {
+                    chunk.inputs.push_back(cell);
+                    return;
+                }
+                if (index > stateCount || cell.empty() || cell == UNDEFINED_NAME)
+                {
+                    return;
+                }
+
+                size_t slash = cell.find('/');
+                if (slash == string_view::npos)
+                {
+                    if (warn)
+                    {
+                        chunk.errors << "Error: Invalid transition format." << endl;
+                    }
+                    return;
+                }
+                chunk.next[rowBegin + index - 1] = resolveState(states, cell.substr(0, slash), chunk.errors);
+                chunk.out[rowBegin + index - 1] = chunk.outputs.intern(orUndefined(cell.substr(slash + 1)));
+            });
+
+            if (cellCount <= stateCount && warn)
+            {
+                chunk.errors << "Error: Not enough columns in input file." << endl;
+            }
+        }
+        chunk.hasUndefinedOut = find(chunk.out.begin(), chunk.out.end(), NO_STATE) != chunk.out.end();
+    }
+
+    void parseMooreRows(RowChunk& chunk, const NameTable& states)
+    {
+        size_t stateCount = states.size();
+        const char* p = chunk.begin;
+        while ((p = skipBlankLines(p, chunk.end)) != chunk.end)
+        {
+            size_t rowBegin = chunk.next.size();
+            chunk.next.resize(rowBegin + stateCount, NO_STATE);
+
+            p = parseRow(p, chunk.end, [&](size_t index, string_view cell)
+            {
+                if (index == 0)
+                {
+                    chunk.inputs.push_back(cell);
+                }
+                else if (index <= stateCount)
+                {
+                    chunk.next[rowBegin + index - 1] = resolveState(states, cell, chunk.errors);
+                }
+            });
+        }
+    }
+}
+
+void parseMealyCsv(string_view data, MealyTable& mealy, ThreadPool& pool)
+{
+    data = withoutBom(data);
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    p = parseRow(skipBlankLines(p, end), end, [&mealy](size_t index, string_view cell)
+    {
+        if (index > 0)
+        {
+            mealy.states.add(cell);
+        }
+    });
+
+    vector<RowChunk> chunks = parseRowChunks(p, end, pool, [&mealy](RowChunk& chunk)
+    {
+        parseMealyRows(chunk, mealy.states);
+    });
+
+    // Слияние в порядке файла: входы и выходы получают те же номера, что при разборе одним потоком.
+    vector<vector<SymbolId>> outputIds(chunks.size());
+    bool hasUndefinedOut = false;
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        for (string_view input : chunks[c].inputs)
+        {
+            mealy.inputs.add(input);
+        }
+        for (const auto& output : chunks[c].outputs.names)
+        {
+            outputIds[c].push_back(mealy.outputs.intern(output));
+        }
+        hasUndefinedOut = hasUndefinedOut || chunks[c].hasUndefinedOut;
+    }
+    // Выход "-" добавляется в таблицу имён, только если он действительно встретился.
+    SymbolId undefinedOut = hasUndefinedOut ? mealy.outputs.intern(UNDEFINED_NAME) : NO_STATE;
+
+    mealy.next.resize(mealy.stateCount() * mealy.inputCount());
+    mealy.out.resize(mealy.next.size());
+    transposeChunks(chunks, mealy.stateCount(), pool, [&](size_t c, size_t cell, size_t position)
+    {
+        SymbolId out = chunks[c].out[cell];
+        mealy.next[position] = chunks[c].next[cell];
+        mealy.out[position] = out == NO_STATE ? undefinedOut : outputIds[c][out];
+    });
+}
+
+void parseMooreCsv(string_view data, MooreTable& moore, ThreadPool& pool)
+{
+    data = withoutBom(data);
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    vector<string_view> outputNames;
+    p = parseRow(skipBlankLines(p, end), end, [&outputNames](size_t index, string_view cell)
+    {
+        if (index > 0)
+        {
+            outputNames.push_back(cell);
+        }
+    });
+    p = parseRow(skipBlankLines(p, end), end, [&](size_t index, string_view cell)
+    {
+        if (index > 0)
+        {
+            moore.states.add(cell);
+            moore.out.push_back(moore.outputs.intern(index <= outputNames.size()
+                ? outputNames[index - 1]
+                : string_view(UNDEFINED_NAME)));
+        }
+    });
+
+    vector<RowChunk> chunks = parseRowChunks(p, end, pool, [&moore](RowChunk& chunk)
+    {
+        parseMooreRows(chunk, moore.states);
+    });
+
+    for (const auto& chunk : chunks)
+    {
+        for (string_view input : chunk.inputs)
+        {
+            moore.inputs.add(input);
+        }
+    }
+
+    moore.next.resize(moore.stateCount() * moore.inputCount());
+    transposeChunks(chunks, moore.stateCount(), pool, [&](size_t c, size_t cell, size_t position)
+    {
+        moore.next[position] = chunks[c].next[cell];
+    });
+}
+
+void parseMealyCsv(string_view data, SparseMealy& mealy)
+{
+    data = withoutBom(data);
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    p = parseRow(skipBlankLines(p, end), end, [&mealy](size_t index, string_view cell)
+    {
+        if (index > 0)
+        {
+            mealy.states.add(cell);
+        }
+    });
+
+    size_t stateCount = mealy.stateCount();
+    vector<SparseCell> cells;
+    // Ячейки, у которых задан выход; остальные получают выход "-", как в плотной таблице.
+    size_t cellsWithOutput = 0;
+
+    while ((p = skipBlankLines(p, end)) != end)
+    {
+        SymbolId input = SymbolId(mealy.inputCount());
+        size_t cellCount = 0;
+        p = parseRow(p, end, [&](size_t index, string_view cell)
+        {
+            cellCount = index + 1;
+            if (index == 0)
+            {
+                mealy.inputs.add(cell);
+                return;
+            }
+            if (index > stateCount || cell.empty() || cell == UNDEFINED_NAME)
+            {
+                return;
+            }
+
+            size_t slash = cell.find('/');
+            if (slash == string_view::npos)
+            {
+                if (logEnabled(Verbosity::Warning))
+                {
+                    cerr << "Error: Invalid transition format." << endl;
+                }
+                return;
+            }
+            StateId next = resolveState(mealy.states, cell.substr(0, slash));
+            string_view output = orUndefined(cell.substr(slash + 1));
+            SymbolId out = mealy.outputs.intern(output);
+            cellsWithOutput++;
+            if (next != NO_STATE || output != UNDEFINED_NAME)
+            {
+                cells.push_back({ StateId(index - 1), input, next, out });
+            }
+        });
+
+        if (cellCount <= stateCount && logEnabled(Verbosity::Warning))
+        {
+            cerr << "Error: Not enough columns in input file." << endl;
+        }
+    }
+
+    if (cellsWithOutput < stateCount * mealy.inputCount())
+    {
+        mealy.outputs.intern(UNDEFINED_NAME);
+    }
+
+    mealy.symbols.resize(cells.size());
+    mealy.next.resize(cells.size());
+    mealy.out.resize(cells.size());
+    distributeCells(stateCount, cells, mealy.offsets, [&mealy](size_t position, const SparseCell& cell)
+    {
+        mealy.symbols[position] = cell.input;
+        mealy.next[position] = cell.next;
+        mealy.out[position] = cell.out;
+    });
+}
+
+void parseMooreCsv(string_view data, SparseMoore& moore)
+{
+    data = withoutBom(data);
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    vector<string_view> outputNames;
+    p = parseRow(skipBlankLines(p, end), end, [&outputNames](size_t index, string_view cell)
+    {
+        if (index > 0)
+        {
+            outputNames.push_back(cell);
+        }
+    });
+    p = parseRow(skipBlankLines(p, end), end, [&](size_t index, string_view cell)
+    {
+        if (index > 0)
+        {
+            moore.states.add(cell);
+            moore.out.push_back(moore.outputs.intern(index <= outputNames.size()
+                ? outputNames[index - 1]
+                : string_view(UNDEFINED_NAME)));
+        }
+    });
+
+    size_t stateCount = moore.stateCount();
+    vector<SparseCell> cells;
+
+    while ((p = skipBlankLines(p, end)) != end)
+    {
+        SymbolId input = SymbolId(moore.inputCount());
+        p = parseRow(p, end, [&](size_t index, string_view cell)
+        {
+            if (index == 0)
+            {
+                moore.inputs.add(cell);
+            }
+            else if (index <= stateCount)
+            {
+                StateId next = resolveState(moore.states, cell);
+                if (next != NO_STATE)
+                {
+                    cells.push_back({ StateId(index - 1), input, next, 0 });
+                }
+            }
+        });
+    }
+
+    moore.symbols.resize(cells.size());
+    moore.next.resize(cells.size());
+    distributeCells(stateCount, cells, moore.offsets, [&moore](size_t position, const SparseCell& cell)
+    {
+        moore.symbols[position] = cell.input;
+        moore.next[position] = cell.next;
+    });
+}
+
+void loadMealyCsv(const string& fileName, MealyTable& mealy, ThreadPool& pool)
+{
+    MappedFile file(fileName);
+    parseMealyCsv(file.view(), mealy, pool);
+}
+
+void loadMooreCsv(const string& fileName, MooreTable& moore, ThreadPool& pool)
+{
+    MappedFile file(fileName);
+    parseMooreCsv(file.view(), moore, pool);
+}
+
+void loadMealyCsv(const string& fileName, SparseMealy& mealy)
+{
+    MappedFile file(fileName);
+    parseMealyCsv(file.view(), mealy);
+}
+
+void loadMooreCsv(const string& fileName, SparseMoore& moore)
+{
+    MappedFile file(fileName);
+    parseMooreCsv(file.view(), moore);
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <string>
+#include <string_view>
+
+#include "Automaton.h"
+#include "SparseAutomaton.h"
+#include "ThreadPool.h"
+
+// Загрузка таблиц автоматов из CSV. Файл отображается в память и разбирается
+// на месте через string_view, разделители ищутся векторными инструкциями.
+// Ошибки открытия файла сообщаются исключением std::runtime_error,
+// ошибки в отдельных ячейках — в cerr, такие переходы считаются неопределёнными.
+// Плотные таблицы из больших файлов разбираются в пуле потоков отрезками по строкам входов;
+// номера имён и сообщения об ошибках те же, что при разборе одним потоком.
+
+// ;s0;s1;...
+// x1;s1/y1;s0/y2;...
+void loadMealyCsv(const std::string& fileName, MealyTable& mealy, ThreadPool& pool = ThreadPool::instance());
+void parseMealyCsv(std::string_view data, MealyTable& mealy, ThreadPool& pool = ThreadPool::instance());
+// Разреженная загрузка: хранятся только непустые ячейки, результат совпадает с toSparse
+// от плотной таблицы, прочитанной из того же файла.
+void loadMealyCsv(const std::string& fileName, SparseMealy& mealy);
+void parseMealyCsv(std::string_view data, SparseMealy& mealy);
+
+// ;y1;y2;...
+// ;s0;s1;...
+// x1;s1;s0;...
+void loadMooreCsv(const std::string& fileName, MooreTable& moore, ThreadPool& pool = ThreadPool::instance());
+void parseMooreCsv(std::string_view data, MooreTable& moore, ThreadPool& pool = ThreadPool::instance());
+void loadMooreCsv(const std::string& fileName, SparseMoore& moore);
+void parseMooreCsv(std::string_view data, SparseMoore& moore);
+
+// Первый из символов first, second в [begin, end) или end, если их нет.
+const char* findEither(const char* begin, const char* end, char first, char second);
@@ -0,0 +1,202 @@
+﻿#include "CsvWriter.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "OutputFile.h"
+
+using namespace std;
+
+namespace
+{
+    // Примерный размер одного блока строк в байтах.
+    constexpr size_t BLOCK_BYTES = size_t(1) << 20;
+
+    size_t namesLength(const NameTable& names)
+    {
+        size_t length = 0;
+        for (const auto& name : names.names)
+        {
+            length += name.size();
+        }
+        return length;
+    }
+
+    // Разбиение таблицы inputCount × stateCount на блоки: блок — это либо несколько
+    // целых строк, либо часть одной широкой строки.
+    struct BlockLayout
+    {
+        size_t rowsPerBlock;
+        size_t chunksPerRow;
+        size_t columnsPerChunk;
+        size_t blockCount;
+    };
+
+    BlockLayout makeLayout(size_t inputCount, size_t stateCount, size_t cellBytes)
+    {
+        BlockLayout layout;
+        size_t cellsPerBlock = max<size_t>(1, BLOCK_BYTES / max<size_t>(1, cellBytes));
+        if (stateCount <= cellsPerBlock)
+        {
+            layout.rowsPerBlock = max<size_t>(1, cellsPerBlock / max<size_t>(1, stateCount));
+            layout.chunksPerRow = 1;
+            layout.columnsPerChunk = stateCount;
+            layout.blockCount = (inputCount + layout.rowsPerBlock - 1) / layout.rowsPerBlock;
+        }
+        else
+        {
+            layout.rowsPerBlock = 1;
+            layout.columnsPerChunk = cellsPerBlock;
+            layout.chunksPerRow = (stateCount + cellsPerBlock - 1) / cellsPerBlock;
+            layout.blockCount = inputCount * layout.chunksPerRow;
+        }
+        return layout;
+    }
+
+    // Форматирует блок строк таблицы: appendCell(buffer, state, input) дописывает одну ячейку.
+    template <typename AppendCell>
+    void formatTableBlock(const BlockLayout& layout, size_t block, const NameTable& inputs,
+        size_t stateCount, string& buffer, AppendCell&& appendCell)
+    {
+        size_t firstRow = block / layout.chunksPerRow * layout.rowsPerBlock;
+        size_t lastRow = min(inputs.size(), firstRow + layout.rowsPerBlock);
+        size_t chunk = block % layout.chunksPerRow;
+        size_t firstColumn = chunk * layout.columnsPerChunk;
+        size_t lastColumn = min(stateCount, firstColumn + layout.columnsPerChunk);
+
+        for (size_t j = firstRow; j < lastRow; j++)
+        {
+            if (chunk == 0)
+            {
+                buffer += inputs[SymbolId(j)];
+            }
+            for (size_t i = firstColumn; i < lastColumn; i++)
+            {
+                buffer += ';';
+                appendCell(buffer, i, j);
+            }
+            if (chunk + 1 == layout.chunksPerRow)
+            {
+                buffer += '\n';
+            }
+        }
+    }
+
+    void appendHeader(string& buffer, const vector<string>& names)
+    {
+        for (const auto& name : names)
+        {
+            buffer += ';';
+            buffer += name;
+        }
+        buffer += '\n';
+    }
+}
+
+size_t writeBlocksInOrder(ostream& output, size_t blockCount, const function<void(size_t, string&)>& formatBlock,
+    ThreadPool& pool)
+{
+    // Блоки форматируются окнами по два на поток: окно форматируется в пуле,
+    // затем пишется по порядку, и буферы переиспользуются следующим окном.
+    size_t windowSize = min(blockCount, pool.concurrency() * 2);
+    vector<string> buffers(windowSize);
+    size_t written = 0;
+    for (size_t first = 0; first < blockCount; first += windowSize)
+    {
+        size_t count = min(windowSize, blockCount - first);
+        pool.parallelFor(count, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t slot = begin; slot < end; slot++)
+            {
+                buffers[slot].clear();
+                formatBlock(first + slot, buffers[slot]);
+            }
+        });
+        for (size_t slot = 0; slot < count; slot++)
+        {
+            output.write(buffers[slot].data(), streamsize(buffers[slot].size()));
+            written += buffers[slot].size();
+        }
+    }
+    return written;
+}
+
+size_t writeMealyCsv(ostream& output, const MealyTable& mealy, ThreadPool& pool)
+{
+    string header;
+    appendHeader(header, mealy.states.names);
+    output.write(header.data(), streamsize(header.size()));
+
+    size_t stateCount = mealy.stateCount();
+    size_t inputCount = mealy.inputCount();
+    size_t cellBytes = (namesLength(mealy.states) + namesLength(mealy.outputs)) / max<size_t>(1, stateCount) + 3;
+    BlockLayout layout = makeLayout(inputCount, stateCount, cellBytes);
+
+    return header.size() + writeBlocksInOrder(output, layout.blockCount, [&](size_t block, string& buffer)
+    {
+        formatTableBlock(layout, block, mealy.inputs, stateCount, buffer, [&](string& buffer, size_t i, size_t j)
+        {
+            buffer += stateName(mealy.states, mealy.next[i * inputCount + j]);
+            buffer += '/';
+            buffer += mealy.outputs[mealy.out[i * inputCount + j]];
+        });
+    }, pool);
+}
+
+size_t writeMooreCsv(ostream& output, const MooreTable& moore, ThreadPool& pool)
+{
+    string header;
+    for (auto out : moore.out)
+    {
+        header += ';';
+        header += moore.outputs[out];
+    }
+    header += '\n';
+    appendHeader(header, moore.states.names);
+    output.write(header.data(), streamsize(header.size()));
+
+    size_t stateCount = moore.stateCount();
+    size_t inputCount = moore.inputCount();
+    size_t cellBytes = namesLength(moore.states) / max<size_t>(1, stateCount) + 1;
+    BlockLayout layout = makeLayout(inputCount, stateCount, cellBytes);
+
+    return header.size() + writeBlocksInOrder(output, layout.blockCount, [&](size_t block, string& buffer)
+    {
+        formatTableBlock(layout, block, moore.inputs, stateCount, buffer, [&](string& buffer, size_t i, size_t j)
+        {
+            buffer += stateName(moore.states, moore.next[i * inputCount + j]);
+        });
+    }, pool);
+}
+
+size_t saveMealyCsv(const string& fileName, const MealyTable& mealy, ThreadPool& pool)
+{
+    OutputFile output(fileName);
+    if (!output.is_open())
+    {
+        throw runtime_error("Cannot open file " + fileName + " for writing");
+    }
+    size_t size = writeMealyCsv(output.stream(), mealy, pool);
+    if (!output.commit())
+    {
+        throw runtime_error("Cannot write file " + fileName);
+    }
+    return size;
+}
+
+size_t saveMooreCsv(const string& fileName, const MooreTable& moore, ThreadPool& pool)
+{
+    OutputFile output(fileName);
+    if (!output.is_open())
+    {
+        throw runtime_error("Cannot open file " + fileName + " for writing");
+    }
+    size_t size = writeMooreCsv(output.stream(), moore, pool);
+    if (!output.commit())
+    {
+        throw runtime_error("Cannot write file " + fileName);
+    }
+    return size;
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+
+#include "Automaton.h"
+#include "ThreadPool.h"
+
+// Запись таблиц в CSV. Строки форматируются блоками в большие переиспользуемые
+// буферы; на больших таблицах блоки форматируются параллельно в пуле потоков
+// и пишутся в поток строго по порядку. Возвращают число записанных байт.
+size_t writeMealyCsv(std::ostream& output, const MealyTable& mealy, ThreadPool& pool = ThreadPool::instance());
+size_t writeMooreCsv(std::ostream& output, const MooreTable& moore, ThreadPool& pool = ThreadPool::instance());
+
+// То же с открытием файла; при ошибке бросается std::runtime_error.
+size_t saveMealyCsv(const std::string& fileName, const MealyTable& mealy, ThreadPool& pool = ThreadPool::instance());
+size_t saveMooreCsv(const std::string& fileName, const MooreTable& moore, ThreadPool& pool = ThreadPool::instance());
+
+// Форматирует blockCount блоков через formatBlock(block, buffer) в пуле и пишет их в output по порядку.
+size_t writeBlocksInOrder(std::ostream& output, size_t blockCount,
+    const std::function<void(size_t, std::string&)>& formatBlock, ThreadPool& pool);
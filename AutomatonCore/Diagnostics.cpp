@@ -0,0 +1,304 @@
+﻿#include "Diagnostics.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "CommandLine.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    atomic<int> g_verbosity{ int(Verbosity::Warning) };
+    thread_local RunStats* g_activeStats = nullptr;
+
+    double millisecondsBetween(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to)
+    {
+        return chrono::duration<double, milli>(to - from).count();
+    }
+
+    string formatFixed(double value)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.3f", value);
+        return text;
+    }
+
+    uint64_t fileSize(const string& fileName)
+    {
+        error_code error;
+        uintmax_t size = filesystem::file_size(fileName, error);
+        return error ? 0 : uint64_t(size);
+    }
+}
+
+Verbosity parseVerbosity(const string& value)
+{
+    if (value.empty() || value == "info" || value == "2")
+    {
+        return Verbosity::Info;
+    }
+    if (value == "quiet" || value == "0")
+    {
+        return Verbosity::Quiet;
+    }
+    if (value == "warning" || value == "1")
+    {
+        return Verbosity::Warning;
+    }
+    if (value == "debug" || value == "3")
+    {
+        return Verbosity::Debug;
+    }
+    if (value == "trace" || value == "4")
+    {
+        return Verbosity::Trace;
+    }
+    throw runtime_error("Invalid --verbose value " + value);
+}
+
+Verbosity verbosityOption(const CommandLine& commandLine)
+{
+    if (commandLine.has("quiet"))
+    {
+        return Verbosity::Quiet;
+    }
+    return commandLine.has("verbose") ? parseVerbosity(commandLine.option("verbose")) : Verbosity::Warning;
+}
+
+void setVerbosity(Verbosity level)
+{
+    g_verbosity.store(int(level), memory_order_relaxed);
+}
+
+bool logEnabled(Verbosity level)
+{
+    return int(level) <= g_verbosity.load(memory_order_relaxed);
+}
+
+#ifdef _WIN32
+
+double processCpuMilliseconds()
+{
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+    {
+        return 0;
+    }
+    auto ticks = [](const FILETIME& time) { return (uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+    // FILETIME считается в интервалах по 100 нс.
+    return double(ticks(kernel) + ticks(user)) / 10000.0;
+}
+
+uint64_t peakResidentBytes()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return uint64_t(counters.PeakWorkingSetSize);
+}
+
+#else
+
+double processCpuMilliseconds()
+{
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    auto milliseconds = [](const timeval& time) { return double(time.tv_sec) * 1000.0 + double(time.tv_usec) / 1000.0; };
+    return milliseconds(usage.ru_utime) + milliseconds(usage.ru_stime);
+}
+
+uint64_t peakResidentBytes()
+{
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return uint64_t(usage.ru_maxrss);
+#else
+    // В Linux ru_maxrss в килобайтах.
+    return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+}
+
+#endif
+
+RunStats::RunStats()
+    : m_start(chrono::steady_clock::now())
+    , m_last(m_start)
+    , m_startCpu(processCpuMilliseconds())
+    , m_lastCpu(m_startCpu)
+{
+}
+
+void RunStats::mark(const string& phase)
+{
+    auto now = chrono::steady_clock::now();
+    double cpu = processCpuMilliseconds();
+    m_phases.push_back({ phase, millisecondsBetween(m_last, now), cpu - m_lastCpu });
+    m_last = now;
+    m_lastCpu = cpu;
+    if (logEnabled(Verbosity::Info))
+    {
+        cerr << "[info] " << phase << ": " << formatFixed(m_phases.back().wallMilliseconds) << " ms, cpu "
+            << formatFixed(m_phases.back().cpuMilliseconds) << " ms\n";
+    }
+}
+
+void RunStats::refinementRound(size_t blockCount)
+{
+    m_rounds.push_back(blockCount);
+    if (logEnabled(Verbosity::Debug))
+    {
+        cerr << "[debug] refinement round " << m_rounds.size() << ": " << blockCount << " blocks\n";
+    }
+}
+
+void RunStats::setCounter(const string& name, uint64_t value)
+{
+    m_counters[name] = value;
+    if (logEnabled(Verbosity::Debug))
+    {
+        cerr << "[debug] " << name << " = " << value << "\n";
+    }
+}
+
+void RunStats::alphabetReduction(size_t inputs, size_t inputClasses)
+{
+    m_inputs = inputs;
+    m_inputClasses = inputClasses;
+    if (logEnabled(Verbosity::Debug))
+    {
+        cerr << "[debug] input classes: " << inputClasses << " of " << inputs << " inputs\n";
+    }
+}
+
+void RunStats::writeJson(ostream& output) const
+{
+    auto now = chrono::steady_clock::now();
+    output << "{\n  \"wall_ms\": " << formatFixed(millisecondsBetween(m_start, now))
+        << ",\n  \"cpu_ms\": " << formatFixed(processCpuMilliseconds() - m_startCpu)
+        << ",\n  \"peak_rss_bytes\": " << peakResidentBytes()
+        << ",\n  \"bytes_read\": " << m_bytesRead
+        << ",\n  \"bytes_written\": " << m_bytesWritten
+        << ",\n  \"phases\": [";
+    for (size_t i = 0; i < m_phases.size(); i++)
+    {
+        output << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << m_phases[i].name
+            << "\", \"wall_ms\": " << formatFixed(m_phases[i].wallMilliseconds)
+            << ", \"cpu_ms\": " << formatFixed(m_phases[i].cpuMilliseconds) << "}";
+    }
+    output << (m_phases.empty() ? "]" : "\n  ]") << ",\n  \"refinement_rounds\": " << m_rounds.size()
+        << ",\n  \"blocks_per_round\": [";
+    for (size_t i = 0; i < m_rounds.size(); i++)
+    {
+        output << (i == 0 ? "" : ", ") << m_rounds[i];
+    }
+    output << "]";
+    if (m_inputClasses != 0)
+    {
+        output << ",\n  \"alphabet\": {\"inputs\": " << m_inputs << ", \"input_classes\": " << m_inputClasses
+            << ", \"reduction_ratio\": " << formatFixed(double(m_inputs) / double(m_inputClasses)) << "}";
+    }
+    output << ",\n  \"counters\": {";
+    bool first = true;
+    for (const auto& counter : m_counters)
+    {
+        output << (first ? "\n" : ",\n") << "    \"" << counter.first << "\": " << counter.second;
+        first = false;
+    }
+    output << (first ? "}" : "\n  }") << "\n}\n";
+}
+
+void RunStats::save(const string& fileName) const
+{
+    if (fileName.empty())
+    {
+        writeJson(cerr);
+        return;
+    }
+    ofstream output(fileName);
+    writeJson(output);
+    if (!output)
+    {
+        throw runtime_error("Failed to write statistics to " + fileName);
+    }
+}
+
+RunStats* RunStats::active()
+{
+    return g_activeStats;
+}
+
+void RunStats::setActive(RunStats* stats)
+{
+    g_activeStats = stats;
+}
+
+void markPhase(const string& phase)
+{
+    if (g_activeStats)
+    {
+        g_activeStats->mark(phase);
+    }
+}
+
+void recordRefinementRound(size_t blockCount)
+{
+    if (g_activeStats)
+    {
+        g_activeStats->refinementRound(blockCount);
+    }
+}
+
+void recordCounter(const string& name, uint64_t value)
+{
+    if (g_activeStats)
+    {
+        g_activeStats->setCounter(name, value);
+    }
+}
+
+void recordAlphabetReduction(size_t inputs, size_t inputClasses)
+{
+    if (g_activeStats)
+    {
+        g_activeStats->alphabetReduction(inputs, inputClasses);
+    }
+}
+
+void recordFileRead(const string& fileName)
+{
+    if (g_activeStats)
+    {
+        g_activeStats->addBytesRead(fileSize(fileName));
+    }
+}
+
+void recordFileWritten(const string& fileName)
+{
+    if (g_activeStats)
+    {
+        g_activeStats->addBytesWritten(fileSize(fileName));
+    }
+}
@@ -0,0 +1,89 @@
+﻿#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct CommandLine;
+
+// Уровни диагностики. По умолчанию печатаются только предупреждения о
+// некорректных ячейках; --quiet отключает и их, --verbose[=info|debug|trace]
+// добавляет время этапов, раунды разбиения и дамп прочитанных таблиц.
+enum class Verbosity
+{
+    Quiet,
+    Warning,
+    Info,
+    Debug,
+    Trace,
+};
+
+// Пустое значение означает info; допускаются также числа 0..4.
+Verbosity parseVerbosity(const std::string& value);
+// Уровень по опциям --quiet и --verbose.
+Verbosity verbosityOption(const CommandLine& commandLine);
+void setVerbosity(Verbosity level);
+bool logEnabled(Verbosity level);
+
+// Процессорное время всех потоков процесса и пиковый объём резидентной памяти
+// (0, если платформа его не сообщает).
+double processCpuMilliseconds();
+uint64_t peakResidentBytes();
+
+// Статистика одного запуска для отчёта --stats: время этапов по часам и
+// процессорное, число блоков после каждого раунда разбиения, сжатие входного
+// алфавита, счётчики и объём прочитанных и записанных файлов. Библиотечный код пишет в статистику,
+// назначенную активной для своего потока (см. функции record* ниже).
+class RunStats
+{
+public:
+    RunStats();
+
+    // Закрывает этап, начавшийся с предыдущей отметки (или с создания).
+    void mark(const std::string& phase);
+    void refinementRound(size_t blockCount);
+    void setCounter(const std::string& name, uint64_t value);
+    // Сжатие входного алфавита перед разбиением: inputs входов свелись к inputClasses классам.
+    void alphabetReduction(size_t inputs, size_t inputClasses);
+    void addBytesRead(uint64_t bytes) { m_bytesRead += bytes; }
+    void addBytesWritten(uint64_t bytes) { m_bytesWritten += bytes; }
+
+    void writeJson(std::ostream& output) const;
+    // Пишет отчёт в файл или, если имя пустое, в cerr.
+    void save(const std::string& fileName) const;
+
+    static RunStats* active();
+    static void setActive(RunStats* stats);
+
+private:
+    struct Phase
+    {
+        std::string name;
+        double wallMilliseconds = 0;
+        double cpuMilliseconds = 0;
+    };
+
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_last;
+    double m_startCpu = 0;
+    double m_lastCpu = 0;
+    std::vector<Phase> m_phases;
+    std::vector<size_t> m_rounds;
+    std::map<std::string, uint64_t> m_counters;
+    size_t m_inputs = 0;
+    size_t m_inputClasses = 0;
+    uint64_t m_bytesRead = 0;
+    uint64_t m_bytesWritten = 0;
+};
+
+// Запись в активную статистику потока; без неё ничего не делают.
+void markPhase(const std::string& phase);
+void recordRefinementRound(size_t blockCount);
+void recordCounter(const std::string& name, uint64_t value);
+void recordAlphabetReduction(size_t inputs, size_t inputClasses);
+// Размер файла добавляется к прочитанным или записанным байтам.
+void recordFileRead(const std::string& fileName);
+void recordFileWritten(const std::string& fileName);
@@ -0,0 +1,294 @@
+﻿#include "Equivalence.h"
+#include "PairIndex.h"
+
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace
+{
+    // Автомат в общем алфавите двух сравниваемых: входы и выходы перенумерованы
+    // по объединённым таблицам имён.
+    struct MachineView
+    {
+        const vector<StateId>* next = nullptr;
+        const vector<SymbolId>* out = nullptr;
+        size_t inputCount = 0;
+        size_t stateCount = 0;
+        bool moore = false;
+        // Общий вход -> собственный (NO_STATE, если входа нет).
+        vector<uint32_t> inputOf;
+        // Собственный выход -> общий.
+        vector<uint32_t> outputOf;
+        // Общий номер выхода "-": выход автомата Мили на входе, которого у него нет.
+        uint32_t undefinedOutput = NO_STATE;
+
+        StateId target(StateId state, size_t input) const
+        {
+            uint32_t a = inputOf[input];
+            return a == NO_STATE ? NO_STATE : (*next)[size_t(state) * inputCount + a];
+        }
+
+        // Выход перехода; для автомата Мура — выход состояния, в которое он ведёт.
+        // У автомата Мили выход есть и у перехода в неопределённое состояние, как при минимизации.
+        uint32_t transitionOutput(StateId state, size_t input) const
+        {
+            if (moore)
+            {
+                StateId t = target(state, input);
+                return t == NO_STATE ? NO_STATE : outputOf[(*out)[t]];
+            }
+            uint32_t a = inputOf[input];
+            return a == NO_STATE ? undefinedOutput : outputOf[(*out)[size_t(state) * inputCount + a]];
+        }
+
+        uint32_t stateOutput(StateId state) const
+        {
+            return moore ? outputOf[(*out)[state]] : 0;
+        }
+    };
+
+    template <typename Table>
+    MachineView makeView(const Table& table, bool moore, NameTable& inputs, NameTable& outputs)
+    {
+        MachineView view;
+        view.next = &table.next;
+        view.out = &table.out;
+        view.inputCount = table.inputCount();
+        view.stateCount = table.stateCount();
+        view.moore = moore;
+        for (size_t a = 0; a < table.inputCount(); a++)
+        {
+            inputs.intern(table.inputs[uint32_t(a)]);
+        }
+        view.outputOf.resize(table.outputs.size());
+        for (size_t y = 0; y < table.outputs.size(); y++)
+        {
+            view.outputOf[y] = outputs.intern(table.outputs[uint32_t(y)]);
+        }
+        return view;
+    }
+
+    template <typename Table>
+    void mapInputs(MachineView& view, const Table& table, const NameTable& inputs)
+    {
+        view.inputOf.assign(inputs.size(), NO_STATE);
+        for (size_t u = 0; u < inputs.size(); u++)
+        {
+            view.inputOf[u] = table.inputs.find(inputs[uint32_t(u)]);
+        }
+    }
+
+    class UnionFind
+    {
+    public:
+        explicit UnionFind(size_t size) : m_parent(size), m_size(size, 1)
+        {
+            for (size_t i = 0; i < size; i++)
+            {
+                m_parent[i] = uint32_t(i);
+            }
+        }
+
+        uint32_t find(uint32_t x)
+        {
+            while (m_parent[x] != x)
+            {
+                m_parent[x] = m_parent[m_parent[x]];
+                x = m_parent[x];
+            }
+            return x;
+        }
+
+        // Возвращает false, если элементы уже в одном множестве.
+        bool unite(uint32_t x, uint32_t y)
+        {
+            x = find(x);
+            y = find(y);
+            if (x == y)
+            {
+                return false;
+            }
+            if (m_size[x] < m_size[y])
+            {
+                swap(x, y);
+            }
+            m_parent[y] = x;
+            m_size[x] += m_size[y];
+            return true;
+        }
+
+    private:
+        vector<uint32_t> m_parent;
+        vector<uint32_t> m_size;
+    };
+
+    // Пара в обходе: состояния, пара-родитель и вход, по которому в неё пришли.
+    struct PairNode
+    {
+        StateId first;
+        StateId second;
+        uint32_t parent;
+        uint32_t input;
+    };
+
+    // Различие пары на входе u: переходы определены не одинаково или дают разные выходы.
+    bool differs(const MachineView& a, const MachineView& b, StateId p, StateId q, size_t u)
+    {
+        StateId tp = a.target(p, u);
+        StateId tq = b.target(q, u);
+        if ((tp == NO_STATE) != (tq == NO_STATE))
+        {
+            return true;
+        }
+        return a.transitionOutput(p, u) != b.transitionOutput(q, u);
+    }
+
+    // Слово от начальной пары до узла index и вход input после него.
+    vector<uint32_t> traceWord(const vector<PairNode>& nodes, uint32_t index, uint32_t input)
+    {
+        vector<uint32_t> word = { input };
+        for (; nodes[index].parent != NO_STATE; index = nodes[index].parent)
+        {
+            word.push_back(nodes[index].input);
+        }
+        return vector<uint32_t>(word.rbegin(), word.rend());
+    }
+
+    // Хопкрофт–Карп: пары, чьи состояния уже в одном классе, не обходятся.
+    // Возвращает различающее слово или пустой вектор с equivalent = true.
+    vector<uint32_t> hopcroftKarp(const MachineView& a, const MachineView& b, size_t inputCount, bool& equivalent)
+    {
+        size_t offset = a.stateCount;
+        UnionFind classes(a.stateCount + b.stateCount);
+        vector<PairNode> nodes = { { 0, 0, NO_STATE, NO_STATE } };
+        classes.unite(0, uint32_t(offset));
+        for (uint32_t head = 0; head < nodes.size(); head++)
+        {
+            StateId p = nodes[head].first;
+            StateId q = nodes[head].second;
+            for (size_t u = 0; u < inputCount; u++)
+            {
+                if (differs(a, b, p, q, u))
+                {
+                    equivalent = false;
+                    return traceWord(nodes, head, uint32_t(u));
+                }
+                StateId tp = a.target(p, u);
+                StateId tq = b.target(q, u);
+                if (tp != NO_STATE && classes.unite(tp, uint32_t(offset + tq)))
+                {
+                    nodes.push_back({ tp, tq, head, uint32_t(u) });
+                }
+            }
+        }
+        equivalent = true;
+        return {};
+    }
+
+    // Точный обход пар в ширину в поисках различающего слова короче limit.
+    // Возвращает false, если обход превысил бюджет пар.
+    bool shortestWord(const MachineView& a, const MachineView& b, size_t inputCount, size_t limit, size_t budget,
+        vector<uint32_t>& word)
+    {
+        PairIndex visited(a.stateCount + b.stateCount);
+        vector<PairNode> nodes = { { 0, 0, NO_STATE, NO_STATE } };
+        vector<uint32_t> depth = { 0 };
+        visited.insert(0, 0, 0);
+        for (uint32_t head = 0; head < nodes.size() && depth[head] + 1 < limit; head++)
+        {
+            StateId p = nodes[head].first;
+            StateId q = nodes[head].second;
+            for (size_t u = 0; u < inputCount; u++)
+            {
+                if (differs(a, b, p, q, u))
+                {
+                    word = traceWord(nodes, head, uint32_t(u));
+                    return true;
+                }
+                StateId tp = a.target(p, u);
+                StateId tq = b.target(q, u);
+                if (tp != NO_STATE && visited.insert(tp, tq, 0).second)
+                {
+                    if (visited.size() > budget)
+                    {
+                        return false;
+                    }
+                    nodes.push_back({ tp, tq, head, uint32_t(u) });
+                    depth.push_back(depth[head] + 1);
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename Table>
+    EquivalenceResult compare(const Table& first, const Table& second, bool moore)
+    {
+        if (first.stateCount() == 0 || second.stateCount() == 0)
+        {
+            throw runtime_error("Empty automaton.");
+        }
+
+        NameTable inputs;
+        NameTable outputs;
+        MachineView a = makeView(first, moore, inputs, outputs);
+        MachineView b = makeView(second, moore, inputs, outputs);
+        mapInputs(a, first, inputs);
+        mapInputs(b, second, inputs);
+        a.undefinedOutput = b.undefinedOutput = outputs.intern(UNDEFINED_NAME);
+
+        EquivalenceResult result;
+        if (a.stateOutput(0) != b.stateOutput(0))
+        {
+            result.equivalent = false;
+            result.firstOutput = outputs[a.stateOutput(0)];
+            result.secondOutput = outputs[b.stateOutput(0)];
+            return result;
+        }
+
+        vector<uint32_t> word = hopcroftKarp(a, b, inputs.size(), result.equivalent);
+        if (result.equivalent)
+        {
+            return result;
+        }
+        // Точный обход ограничен несколькими проходами по числу состояний.
+        vector<uint32_t> shorter;
+        result.shortest = shortestWord(a, b, inputs.size(), word.size(), 4 * (a.stateCount + b.stateCount), shorter);
+        if (!shorter.empty())
+        {
+            word = shorter;
+        }
+
+        StateId p = 0;
+        StateId q = 0;
+        for (size_t i = 0; i + 1 < word.size(); i++)
+        {
+            p = a.target(p, word[i]);
+            q = b.target(q, word[i]);
+        }
+        auto outputName = [&](const MachineView& view, StateId state)
+        {
+            uint32_t output = view.transitionOutput(state, word.back());
+            return output == NO_STATE ? UNDEFINED_NAME : outputs[output];
+        };
+        result.firstOutput = outputName(a, p);
+        result.secondOutput = outputName(b, q);
+        for (auto u : word)
+        {
+            result.word.push_back(inputs[u]);
+        }
+        return result;
+    }
+}
+
+EquivalenceResult checkEquivalence(const MealyTable& first, const MealyTable& second)
+{
+    return compare(first, second, false);
+}
+
+EquivalenceResult checkEquivalence(const MooreTable& first, const MooreTable& second)
+{
+    return compare(first, second, true);
+}
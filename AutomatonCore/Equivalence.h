@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Automaton.h"
+
+// Проверка эквивалентности двух автоматов одного вида от начальных состояний.
+// Входы и выходы сопоставляются по именам; вход, которого нет в одном из
+// автоматов, считается в нём неопределённым (с выходом "-"). Состояния
+// эквивалентны, если на каждом входе переходы дают одинаковый выход и либо оба
+// не определены, либо ведут в эквивалентные состояния; у автоматов Мура
+// сравниваются и выходы самих состояний. Выход перехода автомата Мили в
+// неопределённое состояние ("-/y1") сравнивается так же, как при минимизации.
+//
+// Решение принимается алгоритмом Хопкрофта–Карпа: обход пар в ширину с
+// объединением классов в системе непересекающихся множеств, почти линейный по
+// числу состояний. При различии слово, найденное обходом, укорачивается точным
+// обходом пар произведения не глубже найденного слова; если этот обход
+// превышает бюджет пар, возвращается слово Хопкрофта–Карпа.
+
+struct EquivalenceResult
+{
+    bool equivalent = true;
+    // Различающее входное слово (имена входов); пустое для автоматов Мура с
+    // разными выходами начальных состояний.
+    std::vector<std::string> word;
+    // Выходы автоматов на последнем символе слова ("-", если переход не определён).
+    std::string firstOutput;
+    std::string secondOutput;
+    // false, если точный обход не уложился в бюджет и слово может быть не кратчайшим.
+    bool shortest = true;
+};
+
+// При пустом автомате бросается std::runtime_error.
+EquivalenceResult checkEquivalence(const MealyTable& first, const MealyTable& second);
+EquivalenceResult checkEquivalence(const MooreTable& first, const MooreTable& second);
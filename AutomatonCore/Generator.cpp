@@ -0,0 +1,236 @@
+﻿#include "Generator.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    // Переходы по состояниям и класс каждого состояния.
+    struct Skeleton
+    {
+        vector<StateId> next;
+        vector<uint32_t> classes;
+        size_t classCount = 0;
+    };
+
+    // Переходы фактора: от класса 0 достижимы все классы (случайное остовное дерево),
+    // остальные переходы случайны.
+    vector<uint32_t> generateClassGraph(size_t classCount, size_t inputCount, mt19937_64& random)
+    {
+        vector<uint32_t> classNext(classCount * inputCount, NO_STATE);
+        vector<size_t> freeSlots;
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            freeSlots.push_back(a);
+        }
+        for (size_t c = 1; c < classCount; c++)
+        {
+            size_t index = random() % freeSlots.size();
+            classNext[freeSlots[index]] = uint32_t(c);
+            freeSlots[index] = freeSlots.back();
+            freeSlots.pop_back();
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                freeSlots.push_back(c * inputCount + a);
+            }
+        }
+        for (auto& target : classNext)
+        {
+            if (target == NO_STATE)
+            {
+                target = uint32_t(random() % classCount);
+            }
+        }
+        return classNext;
+    }
+
+    Skeleton generateSkeleton(const GeneratorOptions& options, mt19937_64& random)
+    {
+        if (options.states == 0 || options.inputs == 0 || options.outputs == 0)
+        {
+            throw runtime_error("Generated automaton needs at least one state, input and output");
+        }
+        if (options.states >= NO_STATE || options.outputs >= NO_STATE)
+        {
+            throw runtime_error("Too many states or outputs for a generated automaton");
+        }
+        if (!(options.unreachable >= 0 && options.unreachable < 1))
+        {
+            throw runtime_error("Unreachable fraction must be in [0, 1)");
+        }
+
+        size_t stateCount = options.states;
+        size_t inputCount = options.inputs;
+        size_t reachableCount = max<size_t>(1, stateCount - size_t(double(stateCount) * options.unreachable));
+        size_t classCount = options.classes == 0 ? reachableCount : min(options.classes, reachableCount);
+        vector<uint32_t> classNext = generateClassGraph(classCount, inputCount, random);
+
+        Skeleton skeleton;
+        skeleton.classCount = classCount;
+        skeleton.next.assign(stateCount * inputCount, NO_STATE);
+        skeleton.classes.assign(stateCount, 0);
+
+        // Обход в ширину с созданием состояний: первый переход в класс создаёт его
+        // состояние, сверх этого создаётся extra состояний. Состояние, созданное
+        // переходом, достижимо; остальные переходы заполняются вторым проходом.
+        vector<StateId> firstMember(classCount, NO_STATE);
+        firstMember[0] = 0;
+        size_t created = 1;
+        size_t extra = reachableCount - classCount;
+        uint64_t createThreshold = inputCount <= 2 ? UINT64_MAX : UINT64_MAX / inputCount * 2;
+        for (size_t head = 0; head < created; head++)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t target = classNext[size_t(skeleton.classes[head]) * inputCount + a];
+                bool create = firstMember[target] == NO_STATE;
+                if (!create && extra > 0 && (head + 1 == created || random() <= createThreshold))
+                {
+                    create = true;
+                    extra--;
+                }
+                if (create)
+                {
+                    if (firstMember[target] == NO_STATE)
+                    {
+                        firstMember[target] = StateId(created);
+                    }
+                    skeleton.classes[created] = target;
+                    skeleton.next[head * inputCount + a] = StateId(created++);
+                }
+            }
+        }
+
+        // Состояния каждого класса подряд: members[offsets[c]..offsets[c + 1]).
+        vector<size_t> offsets(classCount + 1, 0);
+        for (size_t s = 0; s < reachableCount; s++)
+        {
+            offsets[skeleton.classes[s] + 1]++;
+        }
+        for (size_t c = 0; c < classCount; c++)
+        {
+            offsets[c + 1] += offsets[c];
+        }
+        vector<StateId> members(reachableCount);
+        vector<size_t> position(offsets.begin(), offsets.end() - 1);
+        for (size_t s = 0; s < reachableCount; s++)
+        {
+            members[position[skeleton.classes[s]]++] = StateId(s);
+        }
+
+        for (size_t s = 0; s < reachableCount; s++)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                StateId& target = skeleton.next[s * inputCount + a];
+                if (target == NO_STATE)
+                {
+                    uint32_t c = classNext[size_t(skeleton.classes[s]) * inputCount + a];
+                    target = members[offsets[c] + random() % (offsets[c + 1] - offsets[c])];
+                }
+            }
+        }
+
+        // Недостижимые состояния ведут куда угодно.
+        for (size_t s = reachableCount; s < stateCount; s++)
+        {
+            skeleton.classes[s] = uint32_t(random() % classCount);
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                skeleton.next[s * inputCount + a] = StateId(random() % stateCount);
+            }
+        }
+
+        // Перемешивание номеров, начальное состояние остаётся нулевым.
+        vector<StateId> order(stateCount);
+        for (size_t s = 0; s < stateCount; s++)
+        {
+            order[s] = StateId(s);
+        }
+        for (size_t s = stateCount - 1; s > 1; s--)
+        {
+            swap(order[s], order[1 + random() % s]);
+        }
+        Skeleton shuffled;
+        shuffled.classCount = classCount;
+        shuffled.next.resize(skeleton.next.size());
+        shuffled.classes.resize(stateCount);
+        for (size_t s = 0; s < stateCount; s++)
+        {
+            shuffled.classes[order[s]] = skeleton.classes[s];
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                shuffled.next[size_t(order[s]) * inputCount + a] = order[skeleton.next[s * inputCount + a]];
+            }
+        }
+        return shuffled;
+    }
+
+    void fillNames(NameTable& table, char prefix, size_t count)
+    {
+        table.clear();
+        table.names.reserve(count);
+        table.ids.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            table.add(prefix + to_string(i));
+        }
+    }
+}
+
+MealyTable generateMealy(const GeneratorOptions& options)
+{
+    mt19937_64 random(options.seed);
+    Skeleton skeleton = generateSkeleton(options, random);
+
+    size_t inputCount = options.inputs;
+    vector<SymbolId> classOut(skeleton.classCount * inputCount);
+    for (auto& output : classOut)
+    {
+        output = SymbolId(random() % options.outputs);
+    }
+
+    MealyTable mealy;
+    fillNames(mealy.states, 's', options.states);
+    fillNames(mealy.inputs, 'x', inputCount);
+    fillNames(mealy.outputs, 'y', options.outputs);
+    mealy.next = move(skeleton.next);
+    mealy.out.resize(mealy.next.size());
+    for (size_t s = 0; s < options.states; s++)
+    {
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            mealy.out[s * inputCount + a] = classOut[size_t(skeleton.classes[s]) * inputCount + a];
+        }
+    }
+    return mealy;
+}
+
+MooreTable generateMoore(const GeneratorOptions& options)
+{
+    mt19937_64 random(options.seed);
+    Skeleton skeleton = generateSkeleton(options, random);
+
+    vector<SymbolId> classOut(skeleton.classCount);
+    for (auto& output : classOut)
+    {
+        output = SymbolId(random() % options.outputs);
+    }
+
+    MooreTable moore;
+    fillNames(moore.states, 's', options.states);
+    fillNames(moore.inputs, 'x', options.inputs);
+    fillNames(moore.outputs, 'y', options.outputs);
+    moore.next = move(skeleton.next);
+    moore.out.resize(options.states);
+    for (size_t s = 0; s < options.states; s++)
+    {
+        moore.out[s] = classOut[skeleton.classes[s]];
+    }
+    return moore;
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Automaton.h"
+
+// Синтетические автоматы для замеров. Достижимые состояния строятся как покрытие
+// случайного автомата-фактора из classes состояний: каждое состояние относится
+// к классу, и его переход по входу ведёт в класс, заданный фактором. Поэтому
+// минимальный автомат содержит не больше classes состояний (при нескольких
+// выходах почти всегда ровно classes). Недостижимые состояния добавляются
+// отдельно: в них не ведёт ни один переход из достижимых. Номера состояний,
+// кроме начального 0, перемешиваются. Результат полностью определяется options.
+
+struct GeneratorOptions
+{
+    size_t states = 1000;
+    size_t inputs = 4;
+    size_t outputs = 4;
+    // Число классов эквивалентности среди достижимых состояний; 0 — по классу на состояние.
+    size_t classes = 0;
+    // Доля недостижимых состояний, от 0 до 1.
+    double unreachable = 0;
+    uint64_t seed = 1;
+};
+
+// При недопустимых параметрах бросается std::runtime_error.
+MealyTable generateMealy(const GeneratorOptions& options);
+MooreTable generateMoore(const GeneratorOptions& options);
@@ -0,0 +1,266 @@
+﻿#include "Graph.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    // Уровни обхода меньше этого размера разбираются в одном потоке.
+    constexpr size_t PARALLEL_FRONTIER = size_t(1) << 14;
+    constexpr size_t FRONTIER_GRAIN = size_t(1) << 12;
+}
+
+vector<StateId> findReachable(const vector<StateId>& next, size_t stateCount, size_t inputCount, ThreadPool& pool,
+    StateId start)
+{
+    if (stateCount == 0) return {};
+
+    Bitset visited(stateCount);
+    vector<StateId> reachableStates;
+    reachableStates.push_back(start);
+    visited.set(start);
+
+    vector<vector<StateId>> candidates;
+
+    size_t levelBegin = 0;
+    while (levelBegin < reachableStates.size())
+    {
+        size_t levelEnd = reachableStates.size();
+
+        if (levelEnd - levelBegin < PARALLEL_FRONTIER || pool.concurrency() == 1)
+        {
+            for (size_t head = levelBegin; head < levelEnd; head++)
+            {
+                const StateId* row = next.data() + size_t(reachableStates[head]) * inputCount;
+                for (size_t i = 0; i < inputCount; i++)
+                {
+                    if (row[i] != NO_STATE && !visited.testAndSet(row[i]))
+                    {
+                        reachableStates.push_back(row[i]);
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Потоки только читают visited и собирают кандидатов по своим отрезкам уровня;
+            // затем кандидаты сливаются по порядку, как при последовательном обходе.
+            size_t chunkCount = (levelEnd - levelBegin + FRONTIER_GRAIN - 1) / FRONTIER_GRAIN;
+            candidates.resize(max(candidates.size(), chunkCount));
+            pool.parallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk)
+            {
+                for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+                {
+                    auto& found = candidates[chunk];
+                    found.clear();
+                    size_t from = levelBegin + chunk * FRONTIER_GRAIN;
+                    size_t to = min(levelEnd, from + FRONTIER_GRAIN);
+                    for (size_t head = from; head < to; head++)
+                    {
+                        const StateId* row = next.data() + size_t(reachableStates[head]) * inputCount;
+                        for (size_t i = 0; i < inputCount; i++)
+                        {
+                            if (row[i] != NO_STATE && !visited.test(row[i]))
+                            {
+                                found.push_back(row[i]);
+                            }
+                        }
+                    }
+                }
+            });
+
+            for (size_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                for (auto state : candidates[chunk])
+                {
+                    if (!visited.testAndSet(state))
+                    {
+                        reachableStates.push_back(state);
+                    }
+                }
+            }
+        }
+
+        levelBegin = levelEnd;
+    }
+
+    return reachableStates;
+}
+
+StronglyConnectedComponents findStronglyConnectedComponents(const vector<StateId>& next,
+    size_t stateCount, size_t inputCount)
+{
+    constexpr uint32_t UNVISITED = NO_STATE;
+
+    StronglyConnectedComponents result;
+    result.component.assign(stateCount, UNVISITED);
+
+    vector<uint32_t> index(stateCount, UNVISITED);
+    vector<uint32_t> low(stateCount, 0);
+    Bitset onStack(stateCount);
+    vector<StateId> stack;
+    // Кадр рекурсии: состояние и следующий непросмотренный вход.
+    vector<pair<StateId, size_t>> callStack;
+    uint32_t counter = 0;
+
+    for (StateId root = 0; root < stateCount; root++)
+    {
+        if (index[root] != UNVISITED)
+        {
+            continue;
+        }
+
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        onStack.set(root);
+        callStack.emplace_back(root, 0);
+
+        while (!callStack.empty())
+        {
+            StateId v = callStack.back().first;
+            size_t& input = callStack.back().second;
+
+            if (input < inputCount)
+            {
+                StateId t = next[size_t(v) * inputCount + input];
+                input++;
+                if (t == NO_STATE)
+                {
+                    continue;
+                }
+                if (index[t] == UNVISITED)
+                {
+                    index[t] = low[t] = counter++;
+                    stack.push_back(t);
+                    onStack.set(t);
+                    callStack.emplace_back(t, 0);
+                }
+                else if (onStack.test(t))
+                {
+                    low[v] = min(low[v], index[t]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            if (low[v] == index[v])
+            {
+                StateId member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack.reset(member);
+                    result.component[member] = result.count;
+                } while (member != v);
+                result.count++;
+            }
+            if (!callStack.empty())
+            {
+                StateId parent = callStack.back().first;
+                low[parent] = min(low[parent], low[v]);
+            }
+        }
+    }
+
+    return result;
+}
+
+vector<char> findSinkStates(const vector<StateId>& next, size_t stateCount, size_t inputCount)
+{
+    vector<char> sinks(stateCount, 1);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            StateId t = next[s * inputCount + i];
+            if (t != NO_STATE && t != s)
+            {
+                sinks[s] = 0;
+                break;
+            }
+        }
+    }
+    return sinks;
+}
+
+vector<char> findDeadStates(const vector<StateId>& next, size_t stateCount, size_t inputCount)
+{
+    StronglyConnectedComponents components = findStronglyConnectedComponents(next, stateCount, inputCount);
+    vector<char> sinks = findSinkStates(next, stateCount, inputCount);
+
+    // Компонента «живая», если в ней есть цикл, не являющийся петлёй стока.
+    vector<uint32_t> componentSize(components.count, 0);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        componentSize[components.component[s]]++;
+    }
+
+    // Обратные рёбра в формате CSR.
+    vector<uint32_t> offsets(stateCount + 1, 0);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            StateId t = next[s * inputCount + i];
+            if (t != NO_STATE)
+            {
+                offsets[t + 1]++;
+            }
+        }
+    }
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        offsets[s + 1] += offsets[s];
+    }
+    vector<StateId> sources(offsets.back());
+    vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            StateId t = next[s * inputCount + i];
+            if (t != NO_STATE)
+            {
+                sources[fill[t]++] = StateId(s);
+            }
+        }
+    }
+
+    Bitset alive(stateCount);
+    vector<StateId> queue;
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        bool selfLoop = false;
+        for (size_t i = 0; i < inputCount && !selfLoop; i++)
+        {
+            selfLoop = next[s * inputCount + i] == s;
+        }
+        bool cyclic = componentSize[components.component[s]] > 1 || (selfLoop && !sinks[s]);
+        if (cyclic)
+        {
+            alive.set(s);
+            queue.push_back(StateId(s));
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        StateId t = queue[head];
+        for (uint32_t e = offsets[t]; e < offsets[t + 1]; e++)
+        {
+            if (!alive.testAndSet(sources[e]))
+            {
+                queue.push_back(sources[e]);
+            }
+        }
+    }
+
+    vector<char> dead(stateCount, 0);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        dead[s] = !alive.test(s);
+    }
+    return dead;
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Automaton.h"
+#include "ThreadPool.h"
+
+// Анализ графа переходов, заданного плоской таблицей next (states × inputs),
+// как в MealyTable и MooreTable. Неопределённые переходы (NO_STATE) пропускаются.
+
+class Bitset
+{
+public:
+    explicit Bitset(size_t size = 0) : m_words((size + 63) / 64, 0) {}
+
+    bool test(size_t i) const { return (m_words[i / 64] >> (i % 64)) & 1; }
+    void set(size_t i) { m_words[i / 64] |= uint64_t(1) << (i % 64); }
+    void reset(size_t i) { m_words[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+    // Устанавливает бит и возвращает его прежнее значение.
+    bool testAndSet(size_t i)
+    {
+        uint64_t mask = uint64_t(1) << (i % 64);
+        bool wasSet = (m_words[i / 64] & mask) != 0;
+        m_words[i / 64] |= mask;
+        return wasSet;
+    }
+
+private:
+    std::vector<uint64_t> m_words;
+};
+
+// Состояния, достижимые из start, в порядке обхода в ширину. Обход идёт по уровням;
+// большие уровни разбираются параллельно, а результат совпадает с последовательным обходом.
+std::vector<StateId> findReachable(const std::vector<StateId>& next, size_t stateCount, size_t inputCount,
+    ThreadPool& pool, StateId start = 0);
+
+struct StronglyConnectedComponents
+{
+    // Номер компоненты каждого состояния; компоненты нумеруются в порядке
+    // завершения алгоритма Тарьяна (обратный топологический порядок).
+    std::vector<uint32_t> component;
+    uint32_t count = 0;
+};
+
+StronglyConnectedComponents findStronglyConnectedComponents(const std::vector<StateId>& next,
+    size_t stateCount, size_t inputCount);
+
+// Стоки: все определённые переходы состояния ведут в него самого.
+std::vector<char> findSinkStates(const std::vector<StateId>& next, size_t stateCount, size_t inputCount);
+
+// Мёртвые состояния: из них недостижим ни один цикл, кроме петель стоков,
+// то есть любой путь рано или поздно застревает в стоке или обрывается.
+std::vector<char> findDeadStates(const std::vector<StateId>& next, size_t stateCount, size_t inputCount);
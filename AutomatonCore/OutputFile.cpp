@@ -0,0 +1,65 @@
+﻿#include "OutputFile.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+string uniqueFileSuffix()
+{
+    static atomic<uint64_t> counter{ 0 };
+    uint64_t salt = random_device{}() ^ uint64_t(chrono::steady_clock::now().time_since_epoch().count());
+    return to_string(salt) + "-" + to_string(hash<thread::id>{}(this_thread::get_id())) + "-" + to_string(counter++);
+}
+
+OutputFile::OutputFile(const string& fileName, ios::openmode mode)
+    : m_fileName(fileName)
+{
+    error_code error;
+    fs::file_status status = fs::status(fileName, error);
+    if (fs::exists(status) && !fs::is_regular_file(status))
+    {
+        m_stream.open(fileName, mode);
+        return;
+    }
+    m_temporaryName = fileName + ".tmp-" + uniqueFileSuffix();
+    m_stream.open(m_temporaryName, mode);
+}
+
+OutputFile::~OutputFile()
+{
+    if (!m_temporaryName.empty())
+    {
+        m_stream.close();
+        error_code error;
+        fs::remove(m_temporaryName, error);
+    }
+}
+
+bool OutputFile::commit()
+{
+    m_stream.close();
+    if (m_stream.fail())
+    {
+        return false;
+    }
+    if (m_temporaryName.empty())
+    {
+        return true;
+    }
+
+    error_code error;
+    fs::rename(m_temporaryName, m_fileName, error);
+    if (error)
+    {
+        return false;
+    }
+    m_temporaryName.clear();
+    return true;
+}
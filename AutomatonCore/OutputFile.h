@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <fstream>
+#include <string>
+
+// Файл результата. Данные пишутся во временный файл рядом с fileName и заменяют его
+// только в commit(), после успешной записи: прерванная запись не оставляет обрезанного
+// результата, а старый fileName, если это жёсткая ссылка на запись кеша результатов
+// (--cache-link), лишь теряет имя, и запись кеша не меняется. Устройства и каналы
+// (/dev/stdout, /dev/null) пишутся напрямую.
+class OutputFile
+{
+public:
+    explicit OutputFile(const std::string& fileName, std::ios::openmode mode = std::ios::out);
+    // Без commit() временный файл удаляется, fileName остаётся прежним.
+    ~OutputFile();
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    bool is_open() const { return m_stream.is_open(); }
+    std::ofstream& stream() { return m_stream; }
+
+    // Закрывает поток и ставит файл на место fileName; false — ошибка записи или переименования.
+    bool commit();
+
+private:
+    std::string m_fileName;
+    std::string m_temporaryName;
+    std::ofstream m_stream;
+};
+
+// Суффикс имени файла, уникальный среди процессов и потоков.
+std::string uniqueFileSuffix();
@@ -0,0 +1,91 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Automaton.h"
+
+// Открытая адресация по упакованной паре 32-битных номеров (например, состояние
+// и выход или состояния двух автоматов) -> номер. Пара (NO_STATE, NO_STATE)
+// зарезервирована под пустую ячейку.
+class PairIndex
+{
+public:
+    explicit PairIndex(size_t expected)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+        {
+            capacity *= 2;
+        }
+        m_keys.assign(capacity, EMPTY);
+        m_values.resize(capacity);
+    }
+
+    // Возвращает номер пары, присваивая ей value, если её ещё не было;
+    // второй элемент результата — была ли пара добавлена.
+    std::pair<uint32_t, bool> insert(uint32_t first, uint32_t second, uint32_t value)
+    {
+        if ((m_size + 1) * 2 > m_keys.size())
+        {
+            grow();
+        }
+        uint64_t key = (uint64_t(first) << 32) | second;
+        size_t mask = m_keys.size() - 1;
+        for (size_t slot = hash(key) & mask;; slot = (slot + 1) & mask)
+        {
+            if (m_keys[slot] == key)
+            {
+                return { m_values[slot], false };
+            }
+            if (m_keys[slot] == EMPTY)
+            {
+                m_keys[slot] = key;
+                m_values[slot] = value;
+                m_size++;
+                return { value, true };
+            }
+        }
+    }
+
+    size_t size() const { return m_size; }
+
+private:
+    static constexpr uint64_t EMPTY = ~uint64_t(0);
+
+    static size_t hash(uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        return size_t(key);
+    }
+
+    void grow()
+    {
+        std::vector<uint64_t> keys(m_keys.size() * 2, EMPTY);
+        std::vector<uint32_t> values(keys.size());
+        size_t mask = keys.size() - 1;
+        for (size_t i = 0; i < m_keys.size(); i++)
+        {
+            if (m_keys[i] == EMPTY)
+            {
+                continue;
+            }
+            size_t slot = hash(m_keys[i]) & mask;
+            while (keys[slot] != EMPTY)
+            {
+                slot = (slot + 1) & mask;
+            }
+            keys[slot] = m_keys[i];
+            values[slot] = m_values[i];
+        }
+        m_keys.swap(keys);
+        m_values.swap(values);
+    }
+
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_values;
+    size_t m_size = 0;
+};
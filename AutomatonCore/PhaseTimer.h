@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Замер времени этапов обработки: mark(phase) закрывает этап, начавшийся
+// с предыдущей отметки (или с создания таймера).
+class PhaseTimer
+{
+public:
+    PhaseTimer() : m_last(std::chrono::steady_clock::now()) {}
+
+    void mark(const std::string& phase)
+    {
+        auto now = std::chrono::steady_clock::now();
+        m_phases.emplace_back(phase, std::chrono::duration<double, std::milli>(now - m_last).count());
+        m_last = now;
+    }
+
+    // Этапы и их длительность в миллисекундах в порядке отметок.
+    const std::vector<std::pair<std::string, double>>& phases() const { return m_phases; }
+
+    double totalMilliseconds() const
+    {
+        double total = 0;
+        for (const auto& phase : m_phases)
+        {
+            total += phase.second;
+        }
+        return total;
+    }
+
+    void report(std::ostream& output) const
+    {
+        char line[128];
+        output << "Timings:\n";
+        for (const auto& phase : m_phases)
+        {
+            std::snprintf(line, sizeof(line), "  %-14s %12.3f ms\n", phase.first.c_str(), phase.second);
+            output << line;
+        }
+        std::snprintf(line, sizeof(line), "  %-14s %12.3f ms\n", "total", totalMilliseconds());
+        output << line;
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_last;
+    std::vector<std::pair<std::string, double>> m_phases;
+};
@@ -0,0 +1,231 @@
+﻿#include "ResultCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "CommandLine.h"
+#include "Diagnostics.h"
+#include "MappedFile.h"
+#include "OutputFile.h"
+#include "Sha256.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace
+{
+    const string TEMPORARY_PREFIX = "tmp-";
+
+    // Временные файлы упавших процессов удаляются при вытеснении через сутки.
+    constexpr auto STALE_TEMPORARY_AGE = chrono::hours(24);
+
+    // Имя, уникальное среди процессов и потоков, которые делят каталог.
+    string temporaryName()
+    {
+        return TEMPORARY_PREFIX + uniqueFileSuffix();
+    }
+
+    // Записи кеша только для чтения: жёсткую ссылку на запись (--cache-link) нельзя
+    // открыть на запись и испортить запись на месте.
+    constexpr fs::perms READ_ONLY = fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read;
+
+    void warn(const string& message)
+    {
+        if (logEnabled(Verbosity::Warning))
+        {
+            cerr << "Warning: result cache: " << message << endl;
+        }
+    }
+
+    uint64_t parseByteSize(const string& text)
+    {
+        size_t digits = 0;
+        while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9')
+        {
+            digits++;
+        }
+        string suffix = text.substr(digits);
+        uint64_t unit = suffix.empty() ? 1
+            : suffix == "K" || suffix == "k" ? uint64_t(1) << 10
+            : suffix == "M" || suffix == "m" ? uint64_t(1) << 20
+            : suffix == "G" || suffix == "g" ? uint64_t(1) << 30
+            : 0;
+        if (digits == 0 || digits > 12 || unit == 0)
+        {
+            throw runtime_error("Invalid --cache-size value " + text);
+        }
+        return stoull(text.substr(0, digits)) * unit;
+    }
+}
+
+ResultCache::ResultCache(fs::path directory, uint64_t maxBytes, bool hardLinks)
+    : m_directory(move(directory))
+    , m_maxBytes(maxBytes)
+    , m_hardLinks(hardLinks)
+{
+}
+
+string ResultCache::key(const string& inputFileName, const string& mode, const string& options) const
+{
+    MappedFile input(inputFileName);
+    Sha256 hash;
+    hash.update("automata-result-cache\n" + RESULT_CACHE_VERSION + "\n" + mode + "\n" + options + "\n");
+    hash.update(input.view());
+    return hash.hexDigest();
+}
+
+fs::path ResultCache::entryPath(const string& key) const
+{
+    return m_directory / key.substr(0, 2) / key;
+}
+
+bool ResultCache::fetch(const string& key, const string& outputFileName) const
+{
+    fs::path entry = entryPath(key);
+    error_code error;
+    if (!fs::is_regular_file(entry, error))
+    {
+        return false;
+    }
+
+    // Результат появляется под своим именем целиком: сначала временный файл рядом, затем переименование.
+    fs::path temporary = fs::path(outputFileName);
+    temporary += "." + temporaryName();
+    bool linked = false;
+    if (m_hardLinks)
+    {
+        fs::create_hard_link(entry, temporary, error);
+        linked = !error;
+    }
+    if (!linked)
+    {
+        if (!fs::copy_file(entry, temporary, error))
+        {
+            // Запись могла быть вытеснена другим процессом.
+            fs::remove(temporary, error);
+            return false;
+        }
+        // Копия получает права записи, как любой другой результат.
+        fs::permissions(temporary, fs::perms::owner_write, fs::perm_options::add, error);
+    }
+    fs::rename(temporary, outputFileName, error);
+    if (error)
+    {
+        warn("cannot replace " + outputFileName + ": " + error.message());
+        fs::remove(temporary, error);
+        return false;
+    }
+
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), error);
+    return true;
+}
+
+void ResultCache::store(const string& key, const string& outputFileName) const
+{
+    fs::path entry = entryPath(key);
+    fs::path temporary = m_directory / temporaryName();
+    error_code error;
+    fs::create_directories(entry.parent_path(), error);
+    if (error || !fs::copy_file(outputFileName, temporary, error))
+    {
+        warn("cannot store " + outputFileName + ": " + error.message());
+        fs::remove(temporary, error);
+        return;
+    }
+    fs::permissions(temporary, READ_ONLY, error);
+    fs::rename(temporary, entry, error);
+    if (error)
+    {
+        warn("cannot store " + outputFileName + ": " + error.message());
+        fs::remove(temporary, error);
+        return;
+    }
+    evict();
+}
+
+void ResultCache::evict() const
+{
+    struct Entry
+    {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type lastUse;
+    };
+
+    vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    auto now = fs::file_time_type::clock::now();
+    error_code error;
+    for (fs::recursive_directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error))
+    {
+        error_code entryError;
+        if (!it->is_regular_file(entryError))
+        {
+            continue;
+        }
+        Entry entry{ it->path(), it->file_size(entryError), it->last_write_time(entryError) };
+        if (entryError)
+        {
+            continue;
+        }
+        if (entry.path.filename().string().rfind(TEMPORARY_PREFIX, 0) == 0)
+        {
+            if (now - entry.lastUse > STALE_TEMPORARY_AGE)
+            {
+                fs::remove(entry.path, entryError);
+            }
+            continue;
+        }
+        totalBytes += entry.size;
+        entries.push_back(move(entry));
+    }
+
+    if (totalBytes <= m_maxBytes)
+    {
+        return;
+    }
+    sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+    for (const auto& entry : entries)
+    {
+        if (totalBytes <= m_maxBytes)
+        {
+            break;
+        }
+        // Запись, уже удалённая другим процессом, тоже освобождает место.
+        fs::remove(entry.path, error);
+        totalBytes -= entry.size;
+    }
+}
+
+bool runCached(const CommandLine& commandLine, const string& mode, const string& options,
+    const string& inputFileName, const string& outputFileName, const function<bool()>& produce)
+{
+    string directory = commandLine.option("cache");
+    if (directory.empty())
+    {
+        return produce();
+    }
+
+    ResultCache cache(directory, parseByteSize(commandLine.option("cache-size", "1G")), commandLine.has("cache-link"));
+    string key = cache.key(inputFileName, mode, options);
+    if (cache.fetch(key, outputFileName))
+    {
+        markPhase("cache");
+        recordCounter("cache_hit", 1);
+        recordFileRead(inputFileName);
+        recordFileWritten(outputFileName);
+        return true;
+    }
+    markPhase("cache");
+    recordCounter("cache_hit", 0);
+
+    bool saved = produce();
+    if (saved)
+    {
+        cache.store(key, outputFileName);
+    }
+    return saved;
+}
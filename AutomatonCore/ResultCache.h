@@ -0,0 +1,47 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+
+struct CommandLine;
+
+// Номер версии результатов Minimize и MealyMooreConverter в ключе кеша. Увеличивается
+// при любом изменении, после которого тот же вход даёт другой выходной файл:
+// записи прежней версии перестают находиться и со временем вытесняются.
+const std::string RESULT_CACHE_VERSION = "1";
+
+// Кеш результатов на диске, адресуемый содержимым. Ключ — SHA-256 от байтов входного
+// файла, инструмента с режимом, опций, влияющих на выходной файл, и версии.
+// Запись хранится в <dir>/<первые два символа ключа>/<ключ>. Файлы пишутся во временные
+// и атомарно переименовываются, поэтому один каталог могут делить несколько процессов:
+// конкурирующие записи одного ключа одинаковы, а исчезнувшая при вытеснении запись —
+// просто промах. Попадание обновляет время изменения записи; после сохранения, если
+// кеш больше maxBytes, удаляются записи, которые дольше всех не использовались.
+// Записи хранятся только для чтения, а результаты пишутся через OutputFile, поэтому
+// выданная жёсткой ссылкой запись не меняется при следующей записи того же выходного файла.
+class ResultCache
+{
+public:
+    ResultCache(std::filesystem::path directory, uint64_t maxBytes, bool hardLinks);
+
+    std::string key(const std::string& inputFileName, const std::string& mode, const std::string& options) const;
+    // Копирует запись (или создаёт на неё жёсткую ссылку) в outputFileName; false — промах.
+    bool fetch(const std::string& key, const std::string& outputFileName) const;
+    // Сохраняет готовый результат под ключом и вытесняет лишние записи.
+    void store(const std::string& key, const std::string& outputFileName) const;
+
+private:
+    std::filesystem::path entryPath(const std::string& key) const;
+    void evict() const;
+
+    std::filesystem::path m_directory;
+    uint64_t m_maxBytes;
+    bool m_hardLinks;
+};
+
+// Выполняет produce() через кеш из опций --cache=<dir>, --cache-size=<N[K|M|G]> и --cache-link.
+// При попадании produce не вызывается и входной файл не разбирается. produce возвращает false,
+// если результат не записан; такой результат не кешируется. Без --cache просто вызывает produce.
+bool runCached(const CommandLine& commandLine, const std::string& mode, const std::string& options,
+    const std::string& inputFileName, const std::string& outputFileName, const std::function<bool()>& produce);
@@ -0,0 +1,605 @@
+﻿#include "Runner.h"
+#include "CsvWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RUNNER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    // Размер блока входного текста для параллельного прогона.
+    constexpr size_t RUN_BLOCK_BYTES = size_t(1) << 20;
+    // Последовательностей на задачу пула при пакетном прогоне.
+    constexpr size_t SEQUENCE_GRAIN = 1024;
+    // Последовательностей на блок вывода runTextBatch.
+    constexpr size_t OUTPUT_BLOCK_SEQUENCES = 16384;
+    // Индексы сборок знаковые 32-битные, поэтому отрезок входа для ядер ограничен.
+    constexpr size_t MAX_LANE_INDEX = size_t(1) << 31;
+
+    bool isSeparator(char c)
+    {
+        return c == ' ' || c == '\t' || c == ';' || c == ',' || c == '\r';
+    }
+
+    // Разбирает строку в symbols. Неизвестный символ обрывает разбор и возвращается.
+    string_view parseLine(const NameTable& inputs, string_view line, vector<SymbolId>& symbols)
+    {
+        for (size_t i = 0; i < line.size();)
+        {
+            if (isSeparator(line[i]))
+            {
+                i++;
+                continue;
+            }
+            size_t tokenEnd = i;
+            while (tokenEnd < line.size() && !isSeparator(line[tokenEnd]))
+            {
+                tokenEnd++;
+            }
+            string_view token = line.substr(i, tokenEnd - i);
+            SymbolId symbol = inputs.find(token);
+            if (symbol == NO_STATE)
+            {
+                return token;
+            }
+            symbols.push_back(symbol);
+            i = tokenEnd;
+        }
+        return {};
+    }
+
+    // Отрезок пакета для многодорожечных ядер. Позиции считаются от offsets[0],
+    // ячейки таблицы — пары 32-битных слов (строка следующего состояния, выход).
+    struct LaneBatch
+    {
+        const uint32_t* cells;
+        uint32_t inputCount;
+        const SymbolId* inputs;
+        const size_t* offsets;
+        size_t count;
+        SymbolId* outputs;
+        AutomatonRunner::Result* results;
+    };
+
+    // Общая часть ядер: выдача дорожке следующей непустой последовательности
+    // и запись результата закончившейся.
+    template <size_t Width>
+    struct Lanes
+    {
+        alignas(64) uint32_t cursor[Width];
+        alignas(64) uint32_t end[Width];
+        alignas(64) uint32_t row[Width];
+        size_t sequence[Width];
+        size_t nextSequence = 0;
+
+        bool refill(const LaneBatch& batch, size_t lane)
+        {
+            while (nextSequence < batch.count)
+            {
+                size_t i = nextSequence++;
+                uint32_t begin = uint32_t(batch.offsets[i] - batch.offsets[0]);
+                uint32_t finish = uint32_t(batch.offsets[i + 1] - batch.offsets[0]);
+                if (begin == finish)
+                {
+                    batch.results[i] = { 0, 0 };
+                    continue;
+                }
+                cursor[lane] = begin;
+                end[lane] = finish;
+                row[lane] = 0;
+                sequence[lane] = i;
+                return true;
+            }
+            return false;
+        }
+
+        void finish(const LaneBatch& batch, size_t lane) const
+        {
+            size_t i = sequence[lane];
+            uint32_t begin = uint32_t(batch.offsets[i] - batch.offsets[0]);
+            batch.results[i] = { size_t(cursor[lane] - begin), StateId(row[lane] / batch.inputCount) };
+        }
+    };
+
+    void runLanesScalar(const LaneBatch& batch)
+    {
+        constexpr size_t WIDTH = 8;
+        Lanes<WIDTH> lanes;
+        size_t active = 0;
+        while (active < WIDTH && lanes.refill(batch, active))
+        {
+            active++;
+        }
+
+        // Активные дорожки лежат в [0, active): на место опустевшей переносится последняя.
+        while (active > 0)
+        {
+            for (size_t lane = 0; lane < active;)
+            {
+                uint32_t position = lanes.cursor[lane];
+                SymbolId symbol = batch.inputs[position];
+                bool stopped = symbol >= batch.inputCount;
+                if (!stopped)
+                {
+                    const uint32_t* cell = batch.cells + 2 * (size_t(lanes.row[lane]) + symbol);
+                    stopped = cell[0] == NO_STATE;
+                    if (!stopped)
+                    {
+                        batch.outputs[position] = cell[1];
+                        lanes.row[lane] = cell[0];
+                        lanes.cursor[lane] = position + 1;
+                    }
+                }
+                if (stopped || lanes.cursor[lane] == lanes.end[lane])
+                {
+                    lanes.finish(batch, lane);
+                    if (!lanes.refill(batch, lane))
+                    {
+                        active--;
+                        lanes.cursor[lane] = lanes.cursor[active];
+                        lanes.end[lane] = lanes.end[active];
+                        lanes.row[lane] = lanes.row[active];
+                        lanes.sequence[lane] = lanes.sequence[active];
+                        continue;
+                    }
+                }
+                lane++;
+            }
+        }
+    }
+
+#ifdef RUNNER_X86_KERNELS
+    __attribute__((target("avx2")))
+    void runLanesAvx2(const LaneBatch& batch)
+    {
+        constexpr size_t WIDTH = 8;
+        Lanes<WIDTH> lanes;
+        alignas(32) int32_t enabled[WIDTH];
+        alignas(32) uint32_t produced[WIDTH];
+        for (size_t lane = 0; lane < WIDTH; lane++)
+        {
+            enabled[lane] = lanes.refill(batch, lane) ? -1 : 0;
+        }
+
+        const int* inputs = reinterpret_cast<const int*>(batch.inputs);
+        const int* nextRows = reinterpret_cast<const int*>(batch.cells);
+        const int* outputs = nextRows + 1;
+        const __m256i allOnes = _mm256_set1_epi32(-1);
+        const __m256i maxSymbol = _mm256_set1_epi32(int(batch.inputCount - 1));
+
+        __m256i active = _mm256_load_si256(reinterpret_cast<const __m256i*>(enabled));
+        __m256i cursor = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.cursor));
+        __m256i end = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.end));
+        __m256i row = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.row));
+
+        while (!_mm256_testz_si256(active, active))
+        {
+            __m256i symbol = _mm256_mask_i32gather_epi32(allOnes, inputs, cursor, active, 4);
+            __m256i inRange = _mm256_and_si256(active,
+                _mm256_cmpeq_epi32(_mm256_min_epu32(symbol, maxSymbol), symbol));
+            __m256i index = _mm256_add_epi32(row, symbol);
+            __m256i next = _mm256_mask_i32gather_epi32(allOnes, nextRows, index, inRange, 8);
+            __m256i output = _mm256_mask_i32gather_epi32(allOnes, outputs, index, inRange, 8);
+            __m256i stepped = _mm256_andnot_si256(_mm256_cmpeq_epi32(next, allOnes), inRange);
+
+            unsigned steppedMask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(stepped)));
+            if (steppedMask != 0)
+            {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes.cursor), cursor);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(produced), output);
+                for (unsigned bits = steppedMask; bits != 0; bits &= bits - 1)
+                {
+                    size_t lane = size_t(__builtin_ctz(bits));
+                    batch.outputs[lanes.cursor[lane]] = produced[lane];
+                }
+            }
+            row = _mm256_blendv_epi8(row, next, stepped);
+            cursor = _mm256_sub_epi32(cursor, stepped);
+
+            __m256i finished = _mm256_or_si256(_mm256_andnot_si256(stepped, active),
+                _mm256_and_si256(stepped, _mm256_cmpeq_epi32(cursor, end)));
+            unsigned finishedMask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(finished)));
+            if (finishedMask == 0)
+            {
+                continue;
+            }
+
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes.cursor), cursor);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes.row), row);
+            for (unsigned bits = finishedMask; bits != 0; bits &= bits - 1)
+            {
+                size_t lane = size_t(__builtin_ctz(bits));
+                lanes.finish(batch, lane);
+                enabled[lane] = lanes.refill(batch, lane) ? -1 : 0;
+            }
+            active = _mm256_load_si256(reinterpret_cast<const __m256i*>(enabled));
+            cursor = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.cursor));
+            end = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.end));
+            row = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.row));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void runLanesAvx512(const LaneBatch& batch)
+    {
+        constexpr size_t WIDTH = 16;
+        Lanes<WIDTH> lanes;
+        __mmask16 active = 0;
+        for (size_t lane = 0; lane < WIDTH; lane++)
+        {
+            if (lanes.refill(batch, lane))
+            {
+                active |= __mmask16(1u << lane);
+            }
+        }
+
+        const int* nextRows = reinterpret_cast<const int*>(batch.cells);
+        const int* outputs = nextRows + 1;
+        const __m512i allOnes = _mm512_set1_epi32(-1);
+        const __m512i one = _mm512_set1_epi32(1);
+        const __m512i inputCount = _mm512_set1_epi32(int(batch.inputCount));
+
+        __m512i cursor = _mm512_load_si512(lanes.cursor);
+        __m512i end = _mm512_load_si512(lanes.end);
+        __m512i row = _mm512_load_si512(lanes.row);
+
+        while (active != 0)
+        {
+            __m512i symbol = _mm512_mask_i32gather_epi32(allOnes, active, cursor, batch.inputs, 4);
+            __mmask16 inRange = _mm512_mask_cmplt_epu32_mask(active, symbol, inputCount);
+            __m512i index = _mm512_add_epi32(row, symbol);
+            __m512i next = _mm512_mask_i32gather_epi32(allOnes, inRange, index, nextRows, 8);
+            __m512i output = _mm512_mask_i32gather_epi32(allOnes, inRange, index, outputs, 8);
+            __mmask16 stepped = _mm512_mask_cmpneq_epu32_mask(inRange, next, allOnes);
+
+            _mm512_mask_i32scatter_epi32(batch.outputs, stepped, cursor, output, 4);
+            row = _mm512_mask_mov_epi32(row, stepped, next);
+            cursor = _mm512_mask_add_epi32(cursor, stepped, cursor, one);
+
+            __mmask16 finished = __mmask16((active & ~stepped) | _mm512_mask_cmpeq_epu32_mask(stepped, cursor, end));
+            if (finished == 0)
+            {
+                continue;
+            }
+
+            _mm512_store_si512(lanes.cursor, cursor);
+            _mm512_store_si512(lanes.row, row);
+            for (unsigned bits = finished; bits != 0; bits &= bits - 1)
+            {
+                size_t lane = size_t(__builtin_ctz(bits));
+                lanes.finish(batch, lane);
+                if (!lanes.refill(batch, lane))
+                {
+                    active = __mmask16(active & ~(1u << lane));
+                }
+            }
+            cursor = _mm512_load_si512(lanes.cursor);
+            end = _mm512_load_si512(lanes.end);
+            row = _mm512_load_si512(lanes.row);
+        }
+    }
+#endif
+}
+
+bool isRunKernelSupported(RunKernel kernel)
+{
+    switch (kernel)
+    {
+    case RunKernel::Sequential:
+    case RunKernel::Scalar:
+        return true;
+#ifdef RUNNER_X86_KERNELS
+    case RunKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case RunKernel::Avx512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+RunKernel bestRunKernel()
+{
+    for (RunKernel kernel : { RunKernel::Avx512, RunKernel::Avx2 })
+    {
+        if (isRunKernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return RunKernel::Scalar;
+}
+
+const char* runKernelName(RunKernel kernel)
+{
+    switch (kernel)
+    {
+    case RunKernel::Sequential: return "sequential";
+    case RunKernel::Scalar: return "scalar";
+    case RunKernel::Avx2: return "avx2";
+    case RunKernel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+void AutomatonRunner::checkSize(size_t stateCount) const
+{
+    if (stateCount * m_inputCount >= NO_STATE)
+    {
+        throw runtime_error("Automaton is too large to run");
+    }
+}
+
+AutomatonRunner::AutomatonRunner(const MealyTable& mealy)
+    : m_inputCount(uint32_t(mealy.inputCount()))
+    , m_inputs(mealy.inputs)
+    , m_outputs(mealy.outputs)
+{
+    checkSize(mealy.stateCount());
+    m_cells.resize(mealy.next.size());
+    for (size_t i = 0; i < m_cells.size(); i++)
+    {
+        StateId target = mealy.next[i];
+        m_cells[i] = { target == NO_STATE ? NO_STATE : target * m_inputCount, mealy.out[i] };
+    }
+}
+
+AutomatonRunner::AutomatonRunner(const MooreTable& moore)
+    : m_inputCount(uint32_t(moore.inputCount()))
+    , m_inputs(moore.inputs)
+    , m_outputs(moore.outputs)
+{
+    checkSize(moore.stateCount());
+    m_cells.resize(moore.next.size());
+    for (size_t i = 0; i < m_cells.size(); i++)
+    {
+        StateId target = moore.next[i];
+        m_cells[i] = target == NO_STATE
+            ? Cell{ NO_STATE, NO_STATE }
+            : Cell{ target * m_inputCount, moore.out[target] };
+    }
+}
+
+void AutomatonRunner::runInterleaved(const SymbolId* inputs, const size_t* offsets, size_t count,
+    SymbolId* outputs, Result* results, RunKernel kernel) const
+{
+    if (kernel == RunKernel::Sequential || offsets[count] - offsets[0] >= MAX_LANE_INDEX
+        || m_cells.size() >= MAX_LANE_INDEX)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            results[i] = run(0, inputs + offsets[i], offsets[i + 1] - offsets[i], outputs + offsets[i]);
+        }
+        return;
+    }
+
+    LaneBatch batch{ reinterpret_cast<const uint32_t*>(m_cells.data()), m_inputCount,
+        inputs + offsets[0], offsets, count, outputs + offsets[0], results };
+#ifdef RUNNER_X86_KERNELS
+    if (kernel == RunKernel::Avx512)
+    {
+        runLanesAvx512(batch);
+        return;
+    }
+    if (kernel == RunKernel::Avx2)
+    {
+        runLanesAvx2(batch);
+        return;
+    }
+#endif
+    runLanesScalar(batch);
+}
+
+void AutomatonRunner::runBatch(const vector<SymbolId>& inputs, const vector<size_t>& offsets,
+    vector<SymbolId>& outputs, vector<Result>& results, ThreadPool& pool, RunKernel kernel) const
+{
+    if (!isRunKernelSupported(kernel))
+    {
+        throw runtime_error(string("Run kernel ") + runKernelName(kernel) + " is not supported by this processor");
+    }
+
+    size_t sequenceCount = offsets.empty() ? 0 : offsets.size() - 1;
+    outputs.resize(inputs.size());
+    results.resize(sequenceCount);
+    if (m_cells.empty())
+    {
+        fill(results.begin(), results.end(), Result{});
+        return;
+    }
+
+    pool.parallelFor(sequenceCount, SEQUENCE_GRAIN, [&](size_t begin, size_t end)
+    {
+        runInterleaved(inputs.data(), offsets.data() + begin, end - begin, outputs.data(), results.data() + begin, kernel);
+    });
+}
+
+RunSummary runTextStream(const AutomatonRunner& runner, string_view input, ostream& output, ostream& errors,
+    ThreadPool& pool)
+{
+    if (input.substr(0, 3) == "\xEF\xBB\xBF")
+    {
+        input.remove_prefix(3);
+    }
+
+    // Границы блоков сдвигаются к концу строки, чтобы строка не делилась между блоками.
+    vector<size_t> blockBegin;
+    for (size_t position = 0; position < input.size();)
+    {
+        blockBegin.push_back(position);
+        size_t end = input.find('\n', min(input.size(), position + RUN_BLOCK_BYTES));
+        position = end == string_view::npos ? input.size() : end + 1;
+    }
+    blockBegin.push_back(input.size());
+    size_t blockCount = blockBegin.size() - 1;
+
+    // Номер первой строки каждого блока нужен только для сообщений об ошибках.
+    vector<size_t> firstLine(blockCount, 1);
+    for (size_t block = 1; block < blockCount; block++)
+    {
+        string_view previous = input.substr(blockBegin[block - 1], blockBegin[block] - blockBegin[block - 1]);
+        firstLine[block] = firstLine[block - 1] + size_t(count(previous.begin(), previous.end(), '\n'));
+    }
+
+    vector<string> blockErrors(blockCount);
+    vector<RunSummary> blockSummary(blockCount);
+
+    writeBlocksInOrder(output, blockCount, [&](size_t block, string& buffer)
+    {
+        vector<SymbolId> symbols;
+        vector<SymbolId> outputs;
+        RunSummary& summary = blockSummary[block];
+        size_t lineNumber = firstLine[block];
+
+        string_view text = input.substr(blockBegin[block], blockBegin[block + 1] - blockBegin[block]);
+        while (!text.empty())
+        {
+            size_t lineEnd = text.find('\n');
+            string_view line = text.substr(0, lineEnd);
+            text.remove_prefix(lineEnd == string_view::npos ? text.size() : lineEnd + 1);
+
+            symbols.clear();
+            string_view unknown = parseLine(runner.inputs(), line, symbols);
+
+            if (!symbols.empty() || !unknown.empty())
+            {
+                outputs.resize(symbols.size());
+                AutomatonRunner::Result result = runner.run(0, symbols.data(), symbols.size(), outputs.data());
+                for (size_t i = 0; i < result.steps; i++)
+                {
+                    if (i != 0)
+                    {
+                        buffer += ' ';
+                    }
+                    buffer += runner.outputs()[outputs[i]];
+                }
+                buffer += '\n';
+                summary.lines++;
+                summary.steps += result.steps;
+
+                if (result.steps < symbols.size())
+                {
+                    summary.failedLines++;
+                    blockErrors[block] += "Error: Undefined transition in line " + to_string(lineNumber)
+                        + " at step " + to_string(result.steps + 1) + ".\n";
+                }
+                else if (!unknown.empty())
+                {
+                    summary.failedLines++;
+                    blockErrors[block] += "Error: Unknown input symbol " + string(unknown)
+                        + " in line " + to_string(lineNumber) + ".\n";
+                }
+            }
+            lineNumber++;
+        }
+    }, pool);
+
+    RunSummary total;
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        errors << blockErrors[block];
+        total.lines += blockSummary[block].lines;
+        total.steps += blockSummary[block].steps;
+        total.failedLines += blockSummary[block].failedLines;
+    }
+    return total;
+}
+
+RunSummary runTextBatch(const AutomatonRunner& runner, string_view input, ostream& output,
+    ostream& errors, ostream& report, ThreadPool& pool, RunKernel kernel)
+{
+    if (input.substr(0, 3) == "\xEF\xBB\xBF")
+    {
+        input.remove_prefix(3);
+    }
+
+    // Неизвестный символ заменяется значением вне алфавита: ядро остановится на нём
+    // так же, как потоковый прогон обрывает разбор строки.
+    vector<SymbolId> symbols;
+    vector<size_t> offsets{ 0 };
+    vector<size_t> lineNumbers;
+    map<size_t, string_view> unknownSymbols;
+    size_t lineNumber = 1;
+    while (!input.empty())
+    {
+        size_t lineEnd = input.find('\n');
+        string_view line = input.substr(0, lineEnd);
+        input.remove_prefix(lineEnd == string_view::npos ? input.size() : lineEnd + 1);
+
+        size_t lineBegin = symbols.size();
+        string_view unknown = parseLine(runner.inputs(), line, symbols);
+        if (!unknown.empty())
+        {
+            unknownSymbols[lineNumbers.size()] = unknown;
+            symbols.push_back(NO_STATE);
+        }
+        if (symbols.size() != lineBegin)
+        {
+            offsets.push_back(symbols.size());
+            lineNumbers.push_back(lineNumber);
+        }
+        lineNumber++;
+    }
+
+    vector<SymbolId> outputs;
+    vector<AutomatonRunner::Result> results;
+    auto started = chrono::steady_clock::now();
+    runner.runBatch(symbols, offsets, outputs, results, pool, kernel);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    RunSummary total;
+    total.lines = results.size();
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        total.steps += results[i].steps;
+        if (offsets[i] + results[i].steps == offsets[i + 1])
+        {
+            continue;
+        }
+        total.failedLines++;
+        auto unknown = unknownSymbols.find(i);
+        if (unknown != unknownSymbols.end() && offsets[i] + results[i].steps + 1 == offsets[i + 1])
+        {
+            errors << "Error: Unknown input symbol " << unknown->second << " in line " << lineNumbers[i] << ".\n";
+        }
+        else
+        {
+            errors << "Error: Undefined transition in line " << lineNumbers[i]
+                << " at step " << results[i].steps + 1 << ".\n";
+        }
+    }
+
+    size_t blockCount = (results.size() + OUTPUT_BLOCK_SEQUENCES - 1) / OUTPUT_BLOCK_SEQUENCES;
+    writeBlocksInOrder(output, blockCount, [&](size_t block, string& buffer)
+    {
+        size_t last = min(results.size(), (block + 1) * OUTPUT_BLOCK_SEQUENCES);
+        for (size_t i = block * OUTPUT_BLOCK_SEQUENCES; i < last; i++)
+        {
+            for (size_t step = 0; step < results[i].steps; step++)
+            {
+                if (step != 0)
+                {
+                    buffer += ' ';
+                }
+                buffer += runner.outputs()[outputs[offsets[i] + step]];
+            }
+            buffer += '\n';
+        }
+    }, pool);
+
+    double traces = double(max<size_t>(total.lines, 1));
+    report << "Kernel: " << runKernelName(kernel) << ", threads: " << pool.concurrency() << "\n"
+        << "Traces: " << total.lines << ", steps: " << total.steps << ", time: " << seconds * 1000 << " ms\n"
+        << "Aggregate: " << (seconds > 0 ? total.steps / seconds / 1e6 : 0) << " Msteps/s, "
+        << (seconds > 0 ? total.lines / seconds / 1e6 : 0) << " Mtraces/s\n"
+        << "Per trace: " << total.steps / traces << " steps, " << seconds * 1e9 / traces << " ns" << endl;
+    return total;
+}
@@ -0,0 +1,120 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Automaton.h"
+#include "ThreadPool.h"
+
+// Способ прогона пакета последовательностей. Sequential проходит их по одной;
+// остальные ведут сразу несколько последовательностей (по дорожке на каждую), чтобы
+// независимые чтения таблицы перекрывались: Scalar — 8 дорожек в обычном коде,
+// Avx2 — 8 дорожек на сборках (gather), Avx512 — 16 дорожек.
+enum class RunKernel
+{
+    Sequential,
+    Scalar,
+    Avx2,
+    Avx512,
+};
+
+// Лучшее ядро, которое поддерживает процессор.
+RunKernel bestRunKernel();
+bool isRunKernelSupported(RunKernel kernel);
+const char* runKernelName(RunKernel kernel);
+
+// Исполнитель автомата. Таблица переходов сворачивается в плоский массив ячеек
+// (строка следующего состояния, выход) с индексом state * inputCount + input,
+// поэтому шаг — одно чтение из памяти без ветвлений по виду автомата.
+// У автомата Мура выходом шага считается выход состояния, в которое он перешёл.
+class AutomatonRunner
+{
+public:
+    explicit AutomatonRunner(const MealyTable& mealy);
+    explicit AutomatonRunner(const MooreTable& moore);
+
+    struct Result
+    {
+        // Число выполненных шагов; меньше длины входа, если встретился
+        // неопределённый переход или неизвестный входной символ.
+        size_t steps = 0;
+        StateId state = 0;
+    };
+
+    // Прогоняет count входных символов из состояния state, выходы пишутся в outputs.
+    Result run(StateId state, const SymbolId* inputs, size_t count, SymbolId* outputs) const
+    {
+        if (m_cells.empty())
+        {
+            return { 0, state };
+        }
+        uint32_t row = state * m_inputCount;
+        size_t i = 0;
+        for (; i < count; i++)
+        {
+            if (inputs[i] >= m_inputCount)
+            {
+                break;
+            }
+            Cell cell = m_cells[row + inputs[i]];
+            if (cell.nextRow == NO_STATE)
+            {
+                break;
+            }
+            outputs[i] = cell.output;
+            row = cell.nextRow;
+        }
+        return { i, StateId(row / m_inputCount) };
+    }
+
+    // Пакет независимых последовательностей, каждая с начального состояния:
+    // последовательность i занимает inputs[offsets[i], offsets[i + 1]),
+    // её выходы пишутся в те же позиции outputs. Результат не зависит от ядра.
+    void runBatch(const std::vector<SymbolId>& inputs, const std::vector<size_t>& offsets,
+        std::vector<SymbolId>& outputs, std::vector<Result>& results, ThreadPool& pool,
+        RunKernel kernel = RunKernel::Sequential) const;
+
+    size_t inputCount() const { return m_inputCount; }
+    const NameTable& inputs() const { return m_inputs; }
+    const NameTable& outputs() const { return m_outputs; }
+
+private:
+    struct Cell
+    {
+        uint32_t nextRow;
+        uint32_t output;
+    };
+    static_assert(sizeof(Cell) == 8, "Cell is gathered as two 32-bit words");
+
+    void checkSize(size_t stateCount) const;
+    void runInterleaved(const SymbolId* inputs, const size_t* offsets, size_t count,
+        SymbolId* outputs, Result* results, RunKernel kernel) const;
+
+    uint32_t m_inputCount = 0;
+    std::vector<Cell> m_cells;
+    NameTable m_inputs;
+    NameTable m_outputs;
+};
+
+// Потоковый прогон текстового файла: каждая непустая строка — последовательность
+// входных символов через пробелы, ';' или ','; для неё пишется строка выходов через
+// пробел. Строки разбираются и прогоняются блоками параллельно, результат пишется
+// по порядку. О неизвестных символах и неопределённых переходах сообщается в errors,
+// выход строки при этом обрывается.
+struct RunSummary
+{
+    size_t lines = 0;
+    size_t steps = 0;
+    size_t failedLines = 0;
+};
+
+RunSummary runTextStream(const AutomatonRunner& runner, std::string_view input, std::ostream& output,
+    std::ostream& errors, ThreadPool& pool);
+
+// То же для пакетного прогона: весь текст разбирается в одну последовательность
+// на строку, прогоняется выбранным ядром, и печатается время с пропускной способностью.
+RunSummary runTextBatch(const AutomatonRunner& runner, std::string_view input, std::ostream& output,
+    std::ostream& errors, std::ostream& report, ThreadPool& pool, RunKernel kernel);
@@ -0,0 +1,26 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// SHA-256 (FIPS 180-4) для ключей кеша результатов.
+class Sha256
+{
+public:
+    Sha256();
+
+    void update(std::string_view data);
+    // Завершает вычисление; после этого объект использовать нельзя.
+    std::array<uint8_t, 32> digest();
+    std::string hexDigest();
+
+private:
+    void processBlock(const uint8_t* block);
+
+    std::array<uint32_t, 8> m_state;
+    std::array<uint8_t, 64> m_buffer{};
+    size_t m_buffered = 0;
+    uint64_t m_length = 0;
+};
@@ -0,0 +1,297 @@
+﻿#include "SparseAutomaton.h"
+
+#include <string>
+
+using namespace std;
+
+namespace
+{
+    // Номер выхода "-" для отсутствующих ячеек; добавляется в таблицу имён при первом обращении.
+    class UndefinedOutput
+    {
+    public:
+        explicit UndefinedOutput(NameTable& outputs) : m_outputs(outputs), m_id(outputs.find(UNDEFINED_NAME)) {}
+
+        SymbolId get()
+        {
+            if (m_id == NO_STATE)
+            {
+                m_id = m_outputs.intern(UNDEFINED_NAME);
+            }
+            return m_id;
+        }
+
+    private:
+        NameTable& m_outputs;
+        SymbolId m_id;
+    };
+
+    vector<StateId> makeRemap(size_t stateCount, const vector<StateId>& keep)
+    {
+        vector<StateId> remap(stateCount, NO_STATE);
+        for (size_t i = 0; i < keep.size(); i++)
+        {
+            remap[keep[i]] = StateId(i);
+        }
+        return remap;
+    }
+
+    vector<StateId> blockRepresentatives(const vector<uint32_t>& blocks, uint32_t blockCount)
+    {
+        vector<StateId> representatives(blockCount, NO_STATE);
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            if (blocks[i] != NO_STATE && representatives[blocks[i]] == NO_STATE)
+            {
+                representatives[blocks[i]] = StateId(i);
+            }
+        }
+        return representatives;
+    }
+}
+
+SparseMealy toSparse(const MealyTable& mealy)
+{
+    SparseMealy result;
+    result.states = mealy.states;
+    result.inputs = mealy.inputs;
+    result.outputs = mealy.outputs;
+
+    SymbolId undefinedOutput = mealy.outputs.find(UNDEFINED_NAME);
+    result.offsets.reserve(mealy.stateCount() + 1);
+    result.offsets.push_back(0);
+    for (size_t s = 0; s < mealy.stateCount(); s++)
+    {
+        for (size_t a = 0; a < mealy.inputCount(); a++)
+        {
+            StateId target = mealy.nextState(StateId(s), SymbolId(a));
+            SymbolId output = mealy.output(StateId(s), SymbolId(a));
+            if (target != NO_STATE || output != undefinedOutput)
+            {
+                result.symbols.push_back(SymbolId(a));
+                result.next.push_back(target);
+                result.out.push_back(output);
+            }
+        }
+        result.offsets.push_back(result.next.size());
+    }
+    return result;
+}
+
+SparseMoore toSparse(const MooreTable& moore)
+{
+    SparseMoore result;
+    result.states = moore.states;
+    result.inputs = moore.inputs;
+    result.outputs = moore.outputs;
+    result.out = moore.out;
+
+    result.offsets.reserve(moore.stateCount() + 1);
+    result.offsets.push_back(0);
+    for (size_t s = 0; s < moore.stateCount(); s++)
+    {
+        for (size_t a = 0; a < moore.inputCount(); a++)
+        {
+            StateId target = moore.nextState(StateId(s), SymbolId(a));
+            if (target != NO_STATE)
+            {
+                result.symbols.push_back(SymbolId(a));
+                result.next.push_back(target);
+            }
+        }
+        result.offsets.push_back(result.next.size());
+    }
+    return result;
+}
+
+MealyTable toDense(const SparseMealy& mealy)
+{
+    MealyTable result;
+    result.states = mealy.states;
+    result.inputs = mealy.inputs;
+    result.outputs = mealy.outputs;
+
+    size_t inputCount = mealy.inputCount();
+    result.next.assign(mealy.stateCount() * inputCount, NO_STATE);
+    result.out.assign(mealy.stateCount() * inputCount, NO_STATE);
+    for (size_t s = 0; s < mealy.stateCount(); s++)
+    {
+        for (size_t i = mealy.offsets[s]; i < mealy.offsets[s + 1]; i++)
+        {
+            result.next[s * inputCount + mealy.symbols[i]] = mealy.next[i];
+            result.out[s * inputCount + mealy.symbols[i]] = mealy.out[i];
+        }
+    }
+
+    UndefinedOutput undefinedOutput(result.outputs);
+    for (auto& out : result.out)
+    {
+        if (out == NO_STATE)
+        {
+            out = undefinedOutput.get();
+        }
+    }
+    return result;
+}
+
+MooreTable toDense(const SparseMoore& moore)
+{
+    MooreTable result;
+    result.states = moore.states;
+    result.inputs = moore.inputs;
+    result.outputs = moore.outputs;
+    result.out = moore.out;
+
+    size_t inputCount = moore.inputCount();
+    result.next.assign(moore.stateCount() * inputCount, NO_STATE);
+    for (size_t s = 0; s < moore.stateCount(); s++)
+    {
+        for (size_t i = moore.offsets[s]; i < moore.offsets[s + 1]; i++)
+        {
+            result.next[s * inputCount + moore.symbols[i]] = moore.next[i];
+        }
+    }
+    return result;
+}
+
+vector<StateId> findReachable(const vector<size_t>& offsets, const vector<StateId>& next, StateId start)
+{
+    size_t stateCount = offsets.empty() ? 0 : offsets.size() - 1;
+    if (start >= stateCount)
+    {
+        return {};
+    }
+
+    vector<char> visited(stateCount, 0);
+    vector<StateId> order;
+    order.push_back(start);
+    visited[start] = 1;
+    for (size_t head = 0; head < order.size(); head++)
+    {
+        StateId p = order[head];
+        for (size_t i = offsets[p]; i < offsets[p + 1]; i++)
+        {
+            StateId t = next[i];
+            if (t != NO_STATE && !visited[t])
+            {
+                visited[t] = 1;
+                order.push_back(t);
+            }
+        }
+    }
+    return order;
+}
+
+SparseMealy restrictStates(const SparseMealy& mealy, const vector<StateId>& keep)
+{
+    SparseMealy result;
+    result.inputs = mealy.inputs;
+    result.outputs = mealy.outputs;
+
+    // Переход в отброшенное состояние с выходом "-" совпадает с пустой ячейкой и не хранится.
+    SymbolId undefinedOutput = mealy.outputs.find(UNDEFINED_NAME);
+    vector<StateId> remap = makeRemap(mealy.stateCount(), keep);
+    result.offsets.reserve(keep.size() + 1);
+    result.offsets.push_back(0);
+    for (auto s : keep)
+    {
+        result.states.add(mealy.states[s]);
+        for (size_t i = mealy.offsets[s]; i < mealy.offsets[s + 1]; i++)
+        {
+            StateId target = mealy.next[i] == NO_STATE ? NO_STATE : remap[mealy.next[i]];
+            if (target != NO_STATE || mealy.out[i] != undefinedOutput)
+            {
+                result.symbols.push_back(mealy.symbols[i]);
+                result.next.push_back(target);
+                result.out.push_back(mealy.out[i]);
+            }
+        }
+        result.offsets.push_back(result.next.size());
+    }
+    return result;
+}
+
+SparseMoore restrictStates(const SparseMoore& moore, const vector<StateId>& keep)
+{
+    SparseMoore result;
+    result.inputs = moore.inputs;
+    result.outputs = moore.outputs;
+
+    vector<StateId> remap = makeRemap(moore.stateCount(), keep);
+    result.offsets.reserve(keep.size() + 1);
+    result.offsets.push_back(0);
+    result.out.reserve(keep.size());
+    for (auto s : keep)
+    {
+        result.states.add(moore.states[s]);
+        result.out.push_back(moore.out[s]);
+        for (size_t i = moore.offsets[s]; i < moore.offsets[s + 1]; i++)
+        {
+            if (remap[moore.next[i]] != NO_STATE)
+            {
+                result.symbols.push_back(moore.symbols[i]);
+                result.next.push_back(remap[moore.next[i]]);
+            }
+        }
+        result.offsets.push_back(result.next.size());
+    }
+    return result;
+}
+
+MealyTable buildQuotient(const SparseMealy& mealy, const vector<uint32_t>& blocks, uint32_t blockCount)
+{
+    MealyTable result;
+    result.inputs = mealy.inputs;
+    result.outputs = mealy.outputs;
+
+    size_t inputCount = mealy.inputCount();
+    vector<StateId> representatives = blockRepresentatives(blocks, blockCount);
+    result.next.assign(size_t(blockCount) * inputCount, NO_STATE);
+    result.out.assign(size_t(blockCount) * inputCount, NO_STATE);
+
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        result.states.add("q" + to_string(b));
+        StateId p = representatives[b];
+        for (size_t i = mealy.offsets[p]; i < mealy.offsets[p + 1]; i++)
+        {
+            StateId target = mealy.next[i];
+            result.next[b * inputCount + mealy.symbols[i]] = target == NO_STATE ? NO_STATE : blocks[target];
+            result.out[b * inputCount + mealy.symbols[i]] = mealy.out[i];
+        }
+    }
+
+    UndefinedOutput undefinedOutput(result.outputs);
+    for (auto& out : result.out)
+    {
+        if (out == NO_STATE)
+        {
+            out = undefinedOutput.get();
+        }
+    }
+    return result;
+}
+
+MooreTable buildQuotient(const SparseMoore& moore, const vector<uint32_t>& blocks, uint32_t blockCount)
+{
+    MooreTable result;
+    result.inputs = moore.inputs;
+    result.outputs = moore.outputs;
+
+    size_t inputCount = moore.inputCount();
+    vector<StateId> representatives = blockRepresentatives(blocks, blockCount);
+    result.next.assign(size_t(blockCount) * inputCount, NO_STATE);
+    result.out.resize(blockCount);
+
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        result.states.add("q" + to_string(b));
+        StateId p = representatives[b];
+        result.out[b] = moore.out[p];
+        for (size_t i = moore.offsets[p]; i < moore.offsets[p + 1]; i++)
+        {
+            result.next[b * inputCount + moore.symbols[i]] = blocks[moore.next[i]];
+        }
+    }
+    return result;
+}
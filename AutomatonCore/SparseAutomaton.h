@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Automaton.h"
+
+// Автоматы с разреженными переходами для таблиц, где большая часть ячеек пуста.
+// Переходы хранятся строками по состояниям (CSR): переходы состояния s занимают
+// позиции offsets[s]..offsets[s + 1] массивов symbols и next по возрастанию входа.
+// Отсутствующая ячейка означает то же, что пустая ячейка CSV: переход в "-" с выходом "-".
+// Память и время обхода пропорциональны числу определённых переходов.
+
+// Автомат Мили. Хранятся только ячейки с определённым переходом или выходом,
+// отличным от "-"; out — выход каждого хранимого перехода.
+struct SparseMealy
+{
+    NameTable states;
+    NameTable inputs;
+    NameTable outputs;
+    std::vector<size_t> offsets;
+    std::vector<SymbolId> symbols;
+    std::vector<StateId> next;
+    std::vector<SymbolId> out;
+
+    size_t stateCount() const { return states.size(); }
+    size_t inputCount() const { return inputs.size(); }
+    size_t transitionCount() const { return next.size(); }
+};
+
+// Автомат Мура. Хранятся только определённые переходы, out — выход каждого состояния.
+struct SparseMoore
+{
+    NameTable states;
+    NameTable inputs;
+    NameTable outputs;
+    std::vector<size_t> offsets;
+    std::vector<SymbolId> symbols;
+    std::vector<StateId> next;
+    std::vector<SymbolId> out;
+
+    size_t stateCount() const { return states.size(); }
+    size_t inputCount() const { return inputs.size(); }
+    size_t transitionCount() const { return next.size(); }
+};
+
+SparseMealy toSparse(const MealyTable& mealy);
+SparseMoore toSparse(const MooreTable& moore);
+MealyTable toDense(const SparseMealy& mealy);
+MooreTable toDense(const SparseMoore& moore);
+
+// Состояния, достижимые из start, в порядке обхода в ширину; порядок совпадает
+// с findReachable для плотной таблицы того же автомата.
+std::vector<StateId> findReachable(const std::vector<size_t>& offsets, const std::vector<StateId>& next,
+    StateId start = 0);
+
+// То же, что restrictStates и buildQuotient для плотных таблиц. Фактор-автомат
+// строится плотным: его записывают те же функции, что и результат обычной минимизации.
+SparseMealy restrictStates(const SparseMealy& mealy, const std::vector<StateId>& keep);
+SparseMoore restrictStates(const SparseMoore& moore, const std::vector<StateId>& keep);
+MealyTable buildQuotient(const SparseMealy& mealy, const std::vector<uint32_t>& blocks, uint32_t blockCount);
+MooreTable buildQuotient(const SparseMoore& moore, const std::vector<uint32_t>& blocks, uint32_t blockCount);
@@ -0,0 +1,189 @@
+﻿#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+using namespace std;
+
+namespace
+{
+    // Пул и номер очереди текущего рабочего потока.
+    thread_local const void* t_pool = nullptr;
+    thread_local size_t t_queue = 0;
+}
+
+ThreadPool::ThreadPool(size_t workerCount)
+{
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_queues.push_back(make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_hasTasks.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool(max(1u, thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    size_t index;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        index = t_pool == this ? t_queue : m_nextQueue++ % m_queues.size();
+    }
+    {
+        lock_guard<mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(move(task));
+    }
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_pending++;
+    }
+    m_hasTasks.notify_one();
+}
+
+bool ThreadPool::takeTask(size_t index, function<void()>& task)
+{
+    // Своя очередь разбирается с конца (последние задачи ещё в кэше),
+    // чужие — с начала, где лежат самые крупные из отложенных задач.
+    for (size_t i = 0; i < m_queues.size(); i++)
+    {
+        WorkerQueue& queue = *m_queues[(index + i) % m_queues.size()];
+        lock_guard<mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    t_pool = this;
+    t_queue = index;
+
+    while (true)
+    {
+        function<void()> task;
+        if (takeTask(index, task))
+        {
+            {
+                lock_guard<mutex> lock(m_mutex);
+                m_pending--;
+            }
+            task();
+            continue;
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+        m_hasTasks.wait(lock, [this]() { return m_stopping || m_pending != 0; });
+        if (m_pending == 0)
+        {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const function<void(size_t, size_t)>& body)
+{
+    grain = max<size_t>(1, grain);
+    size_t chunkCount = (count + grain - 1) / grain;
+    if (chunkCount == 0)
+    {
+        return;
+    }
+    if (chunkCount == 1 || m_workers.empty())
+    {
+        for (size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            body(chunk * grain, min(count, (chunk + 1) * grain));
+        }
+        return;
+    }
+
+    // Состояние живёт, пока его держит хотя бы одна задача: помощник может
+    // проснуться уже после того, как все отрезки разобраны.
+    struct Job
+    {
+        atomic<size_t> nextChunk{ 0 };
+        size_t doneChunks = 0;
+        exception_ptr error;
+        mutex doneMutex;
+        condition_variable done;
+    };
+    auto job = make_shared<Job>();
+
+    auto run = [job, count, grain, chunkCount, &body]()
+    {
+        size_t processed = 0;
+        for (size_t chunk = job->nextChunk++; chunk < chunkCount; chunk = job->nextChunk++)
+        {
+            try
+            {
+                body(chunk * grain, min(count, (chunk + 1) * grain));
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(job->doneMutex);
+                job->error = current_exception();
+            }
+            processed++;
+        }
+        if (processed != 0)
+        {
+            lock_guard<mutex> lock(job->doneMutex);
+            job->doneChunks += processed;
+            if (job->doneChunks == chunkCount)
+            {
+                job->done.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = min(m_workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helperCount; i++)
+    {
+        submit(run);
+    }
+    run();
+
+    unique_lock<mutex> lock(job->doneMutex);
+    job->done.wait(lock, [&job, chunkCount]() { return job->doneChunks == chunkCount; });
+    if (job->error)
+    {
+        rethrow_exception(job->error);
+    }
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул рабочих потоков с перехватом задач: у каждого потока своя очередь, задачи,
+// порождённые внутри задачи, кладутся в очередь своего потока, а свободные потоки
+// забирают работу из начала чужих очередей. Поток, вызвавший parallelFor, тоже
+// выполняет часть работы, поэтому на машине с одним ядром пул пуст и всё
+// выполняется на месте.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Число потоков, участвующих в parallelFor, включая вызывающий.
+    size_t concurrency() const { return m_workers.size() + 1; }
+
+    // Вызывает body(begin, end) для отрезков [0, count) длиной не больше grain
+    // и возвращает управление, когда все отрезки обработаны. Вложенные вызовы из
+    // задач пула допустимы: их отрезки разбирают свободные потоки.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    // Общий пул на hardware_concurrency() потоков.
+    static ThreadPool& instance();
+
+private:
+    struct WorkerQueue
+    {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    void submit(std::function<void()> task);
+    bool takeTask(size_t index, std::function<void()>& task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_hasTasks;
+    size_t m_pending = 0;
+    size_t m_nextQueue = 0;
+    bool m_stopping = false;
+};
@@ -3,414 +3,195 @@
 using namespace std;
 
 const string CONVERSION_TYPE_MEALY_TO_MOORE = "mealy-to-moore";
+const string CONVERSION_TYPE_MOORE_TO_MEALY = "moore-to-mealy";
 
-struct MealyAutomata
+void readMealy(const std::string& inFileName, MealyTable& mealy, FileFormat format)
 {
-    vector<string> states;
-    vector<string> entries;
-    vector<vector<pair<string, string>>> transitions;
-};
-
-struct MooreAutomata
-{
-    vector<pair<string, string>> states;
-    vector<string> entries;
-    vector<vector<string>> transitions;
-};
-
-vector<string> split(const string& s, char delimiter) {
-    vector<string> tokens;
-    string token;
-    istringstream tokenStream(s);
-    while (getline(tokenStream, token, delimiter)) {
-        tokens.push_back(token);
-    }
-    return tokens;
-}
-
-void readMealy(const std::string& inFileName, MealyAutomata& mealy)
-{
-    ifstream input(inFileName);
-
-    string line;
-    getline(input, line);
-    stringstream ss(line);
-    string state;
-    getline(ss, state, ';');
-
-    while (getline(ss, state, ';'))
+    if (format == FileFormat::Cpp)
     {
-        mealy.states.push_back(state);
+        throw runtime_error("Generated C++ source can not be read as an automaton: " + inFileName);
     }
-
-    while (getline(input, line))
+    if (format == FileFormat::Binary)
     {
-        stringstream ss(line);
-        string entry;
-        getline(ss, entry, ';');
-        mealy.entries.push_back(entry);
-
-        string transition;
-        vector<pair<string, string>> transitions;
-        for (const auto& state : mealy.states)
-        {
-            getline(ss, transition, ';');
-            size_t pos = transition.find('/');
-            string transitionState = transition.substr(0, pos);
-            string transitionOut = transition.substr(pos + 1, transition.size());
-            transitions.push_back(make_pair(transitionState, transitionOut));
-        }
-        mealy.transitions.push_back(transitions);
+        loadMealyBinary(inFileName, mealy);
+        return;
     }
+    loadMealyCsv(inFileName, mealy);
 }
 
-void writeMealy(const string& outFileName, MealyAutomata mealy)
+void writeMealy(const string& outFileName, const MealyTable& mealy, FileFormat format)
 {
-    ofstream output(outFileName);
-
-    for (const auto& state : mealy.states)
+    if (format == FileFormat::Binary)
     {
-        output << ";" << state;
+        saveMealyBinary(outFileName, mealy);
+        return;
     }
-    output << std::endl;
-
-    for (size_t i = 0; i < mealy.transitions.size(); i++)
+    if (format == FileFormat::Cpp)
     {
-        output << mealy.entries[i] << ";";
-
-        for (size_t j = 0; j < mealy.transitions[i].size(); j++)
-        {
-            output << mealy.transitions[i][j].first
-                << "/" << mealy.transitions[i][j].second;
-
-            if (j != mealy.transitions[i].size() - 1)
-            {
-                output << ";";
-            }
-        }
-        output << std::endl;
+        CodeGenOptions options;
+        options.name = codeNameFromFile(outFileName);
+        saveMealyCpp(outFileName, mealy, options);
+        return;
     }
+    saveMealyCsv(outFileName, mealy);
 }
 
-void readMoore(const std::string& inFileName, MooreAutomata& moore)
+void readMoore(const std::string& inFileName, MooreTable& moore, FileFormat format)
 {
-    ifstream input(inFileName);
-    string line;
-
-    getline(input, line);
-    istringstream ssOut(line);
-    getline(input, line);
-    istringstream ssState(line);
-
-    string out, state;
-    while (getline(ssOut, out, ';') && getline(ssState, state, ';'))
+    if (format == FileFormat::Cpp)
     {
-        moore.states.emplace_back(state, out);
+        throw runtime_error("Generated C++ source can not be read as an automaton: " + inFileName);
     }
-
-    while (getline(input, line))
+    if (format == FileFormat::Binary)
     {
-        istringstream ss(line);
-        string entry;
-        getline(ss, entry, ';');
-        moore.entries.push_back(entry);
-
-        vector<string> transitions;
-        for (string transition; getline(ss, transition, ';'); )
-        {
-            transitions.push_back(transition);
-        }
-        moore.transitions.push_back(transitions);
+        loadMooreBinary(inFileName, moore);
+        return;
     }
+    loadMooreCsv(inFileName, moore);
 }
 
-void writeMoore(const string& outFileName, MooreAutomata moore)
+void writeMoore(const string& outFileName, const MooreTable& moore, FileFormat format)
 {
-    ofstream output(outFileName);
-
-    for (const auto& state : moore.states)
-    {
-        output << ";" << state.second;
-    }
-    output << std::endl;
-
-    for (const auto& state : moore.states)
+    if (format == FileFormat::Binary)
     {
-        output << ";" << state.first;
+        saveMooreBinary(outFileName, moore);
+        return;
     }
-    output << std::endl;
-
-    for (size_t i = 0; i < moore.transitions.size(); i++)
+    if (format == FileFormat::Cpp)
     {
-        output << moore.entries[i] << ";";
-        for (size_t j = 0; j < moore.transitions[i].size(); j++)
-        {
-            output << moore.transitions[i][j];
-            if (j != moore.transitions[i].size() - 1)
-            {
-                output << ";";
-            }
-        }
-        output << std::endl;
+        CodeGenOptions options;
+        options.name = codeNameFromFile(outFileName);
+        saveMooreCpp(outFileName, moore, options);
+        return;
     }
+    saveMooreCsv(outFileName, moore);
 }
 
-unordered_set<size_t> findReachableStatesMealy(const MealyAutomata& mealy)
+bool convertMooreToMealy(const string& inFileName, const string& outFileName, FileFormat inFormat, FileFormat outFormat)
 {
-    unordered_set<string> reachableStates;
-    queue<string> queue;
-    queue.push(mealy.states[0]);
-    reachableStates.insert(mealy.states[0]);
-
-    while (!queue.empty())
-    {
-        string currentState = queue.front();
-        queue.pop();
-
-        for (size_t i = 0; i < mealy.states.size(); i++)
-        {
-            if (currentState == mealy.states[i])
-            {
-                for (size_t j = 0; j < mealy.entries.size(); j++)
-                {
-                    if (!reachableStates.count(mealy.transitions[j][i].first))
-                    {
-                        queue.push(mealy.transitions[j][i].first);
-                        reachableStates.insert(mealy.transitions[j][i].first);
-                    }
-                }
-                break;
-            }
-        }
-    }
-
-    unordered_set<size_t> reachableStatesIndexes;
-    for (const auto& reachableState : reachableStates)
-    {
-        for (size_t i = 0; i < mealy.states.size(); i++)
-        {
-            if (reachableState == mealy.states[i])
-            {
-                reachableStatesIndexes.insert(i);
-                break;
-            }
-        }
-    }
-
-    return reachableStatesIndexes;
+    MooreTable moore;
+    readMoore(inFileName, moore, inFormat);
+    markPhase("parse");
+    recordFileRead(inFileName);
+    recordCounter("states", moore.stateCount());
+
+    MealyTable mealy = mooreToMealy(moore);
+    markPhase("convert");
+    recordCounter("result_states", mealy.stateCount());
+    writeMealy(outFileName, mealy, outFormat);
+    markPhase("write");
+    recordFileWritten(outFileName);
+    return true;
 }
 
-//unordered_set<size_t> findReachableStatesMealy(const MealyAutomata& mealy)
-//{
-//    unordered_set<string> reachableStates;
-//    queue<string> queue;
-//    queue.push(mealy.states[0]); // Начинаем с начального состояния
-//    reachableStates.insert(mealy.states[0]);
-//
-//    while (!queue.empty())
-//    {
-//        string currentState = queue.front();
-//        queue.pop();
-//
-//        // Ищем индекс текущего состояния
-//        auto it = find(mealy.states.begin(), mealy.states.end(), currentState);
-//        if (it == mealy.states.end())
-//        {
-//            // Если состояние не найдено, пропускаем
-//            continue;
-//        }
-//
-//        size_t currentIndex = distance(mealy.states.begin(), it);
-//
-//        // Проходим по всем входным сигналам
-//        for (size_t j = 0; j < mealy.entries.size(); j++)
-//        {
-//            if (currentIndex >= mealy.transitions[j].size())
-//            {
-//                // Если индекс выходит за пределы, пропускаем
-//                continue;
-//            }
-//
-//            const auto& transition = mealy.transitions[j][currentIndex];
-//            if (!reachableStates.count(transition.first))
-//            {
-//                queue.push(transition.first);
-//                reachableStates.insert(transition.first);
-//            }
-//        }
-//    }
-//
-//    // Преобразуем достижимые состояния в индексы
-//    unordered_set<size_t> reachableStatesIndexes;
-//    for (const auto& reachableState : reachableStates)
-//    {
-//        auto it = find(mealy.states.begin(), mealy.states.end(), reachableState);
-//        if (it != mealy.states.end())
-//        {
-//            reachableStatesIndexes.insert(distance(mealy.states.begin(), it));
-//        }
-//    }
-//
-//    return reachableStatesIndexes;
-//}
-
-vector<pair<string, string>> extractMooreStates(const vector<vector<pair<string, string>>>& mealyTransitions, const std::string& startState)
+bool convertMealyToMoore(const string& inFileName, const string outFileName, FileFormat inFormat, FileFormat outFormat)
 {
-    set<pair<string, string>> statesForMoore;
-    for (const auto& transitionForOneEntry : mealyTransitions)
-    {
-        for (const auto& transition : transitionForOneEntry)
-        {
-            statesForMoore.insert(transition);
-        }
-    }
-
-    vector<pair<string, string>> statesForMooreVector;
-    bool containsStartState = false;
-    for (const auto& state : statesForMoore)
-    {
-        statesForMooreVector.push_back(state);
-        if (state.first == startState)
-        {
-            containsStartState = true;
-        }
-    }
-
-    if (!containsStartState)
-    {
-        statesForMooreVector.insert(statesForMooreVector.begin(), std::make_pair(startState, ""));
-    }
-
-    return statesForMooreVector;
+    MealyTable mealy;
+    readMealy(inFileName, mealy, inFormat);
+    markPhase("parse");
+    recordFileRead(inFileName);
+    recordCounter("states", mealy.stateCount());
+    if (mealy.stateCount() == 0)
+    {
+        cerr << "Error: Empty automaton." << endl;
+        return false;
+    }
+
+    MooreTable moore = mealyToMoore(mealy);
+    markPhase("convert");
+    recordCounter("result_states", moore.stateCount());
+    writeMoore(outFileName, moore, outFormat);
+    markPhase("write");
+    recordFileWritten(outFileName);
+    return true;
 }
 
-void convertMooreToMealy(const string& inFileName, const string& outFileName)
+bool convertFile(const string& convType, const string& inputFileName, const string& outputFileName,
+    const CommandLine& commandLine)
 {
-    ifstream file(inFileName);
-    ofstream outFile(outFileName);
-    string line;
-    getline(file, line);
-    vector<string> tempRowOut = split(line, ';');
-    getline(file, line);
-    vector<string> tempRowStates = split(line, ';');
-
+    FileFormat inFormat = resolveFormat(inputFileName, commandLine.option("in-format"));
+    FileFormat outFormat = resolveFormat(outputFileName, commandLine.option("out-format"));
 
-    unordered_map<string, string> stateToOut;
-
-    for (size_t i = 1; i < tempRowOut.size(); ++i)
+    // Ключ кеша учитывает форматы и, для вывода в C++, имя пространства имён из имени файла.
+    string options = "in=" + to_string(int(inFormat)) + ";out=" + to_string(int(outFormat));
+    if (outFormat == FileFormat::Cpp)
     {
-        stateToOut[tempRowStates[i]] = tempRowOut[i]; 
-        outFile << ";" << tempRowStates[i];
+        options += ";code=" + codeNameFromFile(outputFileName);
     }
-    outFile << "\n";
-
-    while (getline(file, line))
+    return runCached(commandLine, "MealyMooreConverter " + convType, options, inputFileName, outputFileName, [&]
     {
-        vector<string> rowNextSt = split(line, ';');
-        outFile << rowNextSt[0] << ";";
-        for (int i = 1; i < rowNextSt.size(); i++)
+        if (convType == CONVERSION_TYPE_MEALY_TO_MOORE)
         {
-            outFile << rowNextSt[i] << "/" << stateToOut[rowNextSt[i]] << ";";
+            return convertMealyToMoore(inputFileName, outputFileName, inFormat, outFormat);
         }
-        outFile << "\n";
-    }
-    file.close();
-    outFile.close();
+        return convertMooreToMealy(inputFileName, outputFileName, inFormat, outFormat);
+    });
 }
 
-void convertMealyToMoore(const string& inFileName, const string outFileName)
+// Пакетный режим: batch <manifest> или batch <conversion-type> <in-dir> <out-dir>.
+int runBatchConversion(const CommandLine& commandLine)
 {
-    MealyAutomata mealy;
-    readMealy(inFileName, mealy);
+    vector<BatchJob> jobs = commandLine.args.size() == 2
+        ? readManifest(commandLine.args[1])
+        : listDirectoryJobs(commandLine.args[1], commandLine.args[2], commandLine.args[3]);
 
-    MooreAutomata moore;
-
-    unordered_set<size_t> reachableStates = findReachableStatesMealy(mealy);
-
-    MealyAutomata filteredMealy;
-    filteredMealy.entries = mealy.entries;
-    filteredMealy.transitions = vector<vector<pair<string, string>>>(filteredMealy.entries.size());
-    for (const auto& index : reachableStates)
+    size_t failed = runBatch(jobs, [&commandLine](const BatchJob& job)
     {
-        filteredMealy.states.push_back(mealy.states[index]);
-        for (size_t i = 0; i < filteredMealy.entries.size(); i++)
+        if (job.mode != CONVERSION_TYPE_MEALY_TO_MOORE && job.mode != CONVERSION_TYPE_MOORE_TO_MEALY)
         {
-            filteredMealy.transitions[i].push_back(mealy.transitions[i][index]);
+            throw runtime_error("Unknown conversion type " + job.mode);
         }
-    }
-
-    auto statesForMoore = extractMooreStates(filteredMealy.transitions, filteredMealy.states[0]);
-
-    for (size_t i = 0; i < statesForMoore.size(); i++)
-    {
-        moore.states.push_back(make_pair("q" + to_string(i), statesForMoore[i].second));
-    }
-
-    moore.entries = filteredMealy.entries;
-
-    vector<vector<string>> transitionsMoore(filteredMealy.transitions.size(),
-        vector<string>(filteredMealy.transitions[0].size()));
-
-    for (size_t i = 0; i < filteredMealy.transitions.size(); i++)
-    {
-        for (size_t j = 0; j < filteredMealy.transitions[0].size(); j++)
-        {
-            size_t k = 0;
-            auto transition = filteredMealy.transitions[i][j];
-
-            for (const auto& state : statesForMoore)
-            {
-                if (transition == state)
-                {
-                    transitionsMoore[i][j] = moore.states[k].first;
-                }
-                k++;
-            }
-        }
-    }
-
-    vector<vector<string>> transitions(filteredMealy.transitions.size(),
-        vector<string>(statesForMoore.size()));
-
-    for (size_t i = 0; i < moore.states.size(); i++)
-    {
-        for (size_t j = 0; j < moore.entries.size(); j++)
+        if (!convertFile(job.mode, job.input, job.output, commandLine))
         {
-            for (size_t k = 0; k < filteredMealy.states.size(); k++)
-            {
-                if (statesForMoore[i].first == filteredMealy.states[k])
-                {
-                    transitions[j][i] = transitionsMoore[j][k];
-                }
-            }
+            throw runtime_error("Conversion failed.");
         }
-    }
-
-    moore.transitions = transitions;
-
-    writeMoore(outFileName, moore);
+    }, cout, ThreadPool::instance());
+    return failed == 0 ? 0 : 1;
 }
 
 int main(int argc, char* argv[])
 {
-    if (argc != 4)
-    {
-        cout << "Usage: " << argv[0] << " <conversion-type> <in.csv> <out.csv>" << endl;
+    CommandLine commandLine = parseCommandLine(argc, argv);
+    bool batch = !commandLine.args.empty() && commandLine.args[0] == "batch";
+    size_t argCount = commandLine.args.size();
+    if (batch ? argCount != 2 && argCount != 4 : argCount != 3)
+    {
+        cout << "Usage: " << argv[0] << " <conversion-type> <in.csv> <out.csv>"
+            << " [--in-format=csv|bin] [--out-format=csv|bin|cpp]\n"
+            << "       " << argv[0] << " batch <manifest> | batch <conversion-type> <in-dir> <out-dir> [options]\n"
+            << "Manifest lines: <conversion-type>;<in>;<out>\n"
+            << "Diagnostics: [--quiet] [--verbose[=info|debug|trace]] [--stats[=<file.json>]]\n"
+            << "Result cache: [--cache=<dir>] [--cache-size=<N[K|M|G]>] [--cache-link]" << endl;
         return 1;
     }
 
-    string convType = argv[1];
-    string inputFileName = argv[2];
-    string outputFileName = argv[3];
-
-    if (convType == CONVERSION_TYPE_MEALY_TO_MOORE)
+    RunStats stats;
+    bool collectStats = commandLine.has("stats");
+    int status = 0;
+    try
     {
-        convertMealyToMoore(inputFileName, outputFileName);
+        setVerbosity(verbosityOption(commandLine));
+        if (batch)
+        {
+            status = runBatchConversion(commandLine);
+            stats.mark("batch");
+        }
+        else
+        {
+            RunStats::setActive(collectStats ? &stats : nullptr);
+            status = convertFile(commandLine.args[0], commandLine.args[1], commandLine.args[2], commandLine) ? 0 : 1;
+        }
+
+        if (collectStats)
+        {
+            stats.save(commandLine.option("stats"));
+        }
     }
-    else
+    catch (const exception& e)
     {
-        convertMooreToMealy(inputFileName, outputFileName);
+        cerr << e.what() << endl;
+        return 1;
     }
 
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
@@ -6,4 +6,18 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <queue>
-#include <set>
\ No newline at end of file
+#include <set>
+#include <map>
+
+#include "Automaton.h"
+#include "Batch.h"
+#include "BinaryFormat.h"
+#include "CodeGenerator.h"
+#include "CommandLine.h"
+#include "Conversion.h"
+#include "CsvReader.h"
+#include "CsvWriter.h"
+#include "Diagnostics.h"
+#include "Graph.h"
+#include "ResultCache.h"
+#include "ThreadPool.h"
\ No newline at end of file
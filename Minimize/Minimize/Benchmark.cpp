@@ -0,0 +1,313 @@
+﻿#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Automaton.h"
+#include "BinaryFormat.h"
+#include "CommandLine.h"
+#include "Conversion.h"
+#include "CsvReader.h"
+#include "CsvWriter.h"
+#include "Generator.h"
+#include "Minimization.h"
+#include "PhaseTimer.h"
+#include "ThreadPool.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Замеры этапов Minimize и конвертера на синтетических автоматах размером
+// от --min-states до --max-states (через порядок). Каждый этап повторяется
+// --repeat раз, в результат идёт лучшее время. Результаты — CSV или JSON.
+
+struct BenchmarkSettings
+{
+    vector<string> kinds;
+    vector<size_t> sizes;
+    GeneratorOptions generator;
+    // Классов по умолчанию — четверть состояний.
+    size_t classes = 0;
+    string engine;
+    size_t threads = 0;
+    size_t repeat = 1;
+    fs::path workDir;
+};
+
+struct BenchmarkRecord
+{
+    string kind;
+    size_t states = 0;
+    size_t classes = 0;
+    string phase;
+    double milliseconds = 0;
+    // Число состояний результата этапа.
+    size_t resultStates = 0;
+};
+
+double bestOf(size_t repeat, const function<size_t()>& body, size_t& resultStates)
+{
+    double best = numeric_limits<double>::max();
+    for (size_t i = 0; i < repeat; i++)
+    {
+        PhaseTimer timer;
+        resultStates = body();
+        timer.mark("phase");
+        best = min(best, timer.totalMilliseconds());
+    }
+    return best;
+}
+
+template <typename Table, typename Other>
+void BenchmarkKind(const BenchmarkSettings& settings, const string& kind, size_t states, ThreadPool& pool,
+    vector<BenchmarkRecord>& records)
+{
+    constexpr bool isMealy = is_same_v<Table, MealyTable>;
+    GeneratorOptions options = settings.generator;
+    options.states = states;
+    options.classes = settings.classes != 0 ? settings.classes : max<size_t>(1, states / 4);
+    fs::path csvFile = settings.workDir / ("benchmark-" + kind + ".csv");
+    fs::path binFile = settings.workDir / ("benchmark-" + kind + ".bin");
+
+    auto record = [&](const string& phase, const function<size_t()>& body)
+    {
+        BenchmarkRecord result;
+        result.kind = kind;
+        result.states = states;
+        result.classes = options.classes;
+        result.phase = phase;
+        result.milliseconds = bestOf(settings.repeat, body, result.resultStates);
+        cerr << kind << " " << states << " " << phase << ": " << result.milliseconds << " ms\n";
+        records.push_back(result);
+    };
+
+    Table table;
+    record("generate", [&]
+        {
+            if constexpr (isMealy)
+            {
+                table = generateMealy(options);
+            }
+            else
+            {
+                table = generateMoore(options);
+            }
+            return table.stateCount();
+        });
+    record("write-csv", [&]
+        {
+            if constexpr (isMealy)
+            {
+                saveMealyCsv(csvFile.string(), table);
+            }
+            else
+            {
+                saveMooreCsv(csvFile.string(), table);
+            }
+            return table.stateCount();
+        });
+    record("read-csv", [&]
+        {
+            Table loaded;
+            if constexpr (isMealy)
+            {
+                loadMealyCsv(csvFile.string(), loaded);
+            }
+            else
+            {
+                loadMooreCsv(csvFile.string(), loaded);
+            }
+            return loaded.stateCount();
+        });
+    record("write-bin", [&]
+        {
+            if constexpr (isMealy)
+            {
+                saveMealyBinary(binFile.string(), table);
+            }
+            else
+            {
+                saveMooreBinary(binFile.string(), table);
+            }
+            return table.stateCount();
+        });
+    record("read-bin", [&]
+        {
+            Table loaded;
+            if constexpr (isMealy)
+            {
+                loadMealyBinary(binFile.string(), loaded);
+            }
+            else
+            {
+                loadMooreBinary(binFile.string(), loaded);
+            }
+            return loaded.stateCount();
+        });
+    fs::remove(csvFile);
+    fs::remove(binFile);
+
+    Table reachable;
+    record("reachable", [&]
+        {
+            if constexpr (isMealy)
+            {
+                reachable = findMealyReachableStates(table, pool);
+            }
+            else
+            {
+                reachable = findMooreReachableStates(table, pool);
+            }
+            return reachable.stateCount();
+        });
+    table = Table();
+    record("minimize", [&]
+        {
+            if constexpr (isMealy)
+            {
+                return mealyMin(reachable, settings.engine, pool).stateCount();
+            }
+            else
+            {
+                return mooreMin(reachable, settings.engine, pool).stateCount();
+            }
+        });
+    record("convert", [&]
+        {
+            Other converted;
+            if constexpr (isMealy)
+            {
+                converted = mealyToMoore(reachable, pool);
+            }
+            else
+            {
+                converted = mooreToMealy(reachable);
+            }
+            return converted.stateCount();
+        });
+}
+
+void WriteCsv(ostream& output, const BenchmarkSettings& settings, const vector<BenchmarkRecord>& records)
+{
+    output << "kind;states;inputs;outputs;classes;unreachable;seed;engine;threads;phase;milliseconds;result_states\n";
+    for (const auto& record : records)
+    {
+        output << record.kind << ";" << record.states << ";" << settings.generator.inputs << ";"
+            << settings.generator.outputs << ";" << record.classes << ";" << settings.generator.unreachable << ";"
+            << settings.generator.seed << ";" << settings.engine << ";" << settings.threads << ";"
+            << record.phase << ";" << record.milliseconds << ";" << record.resultStates << "\n";
+    }
+}
+
+void WriteJson(ostream& output, const BenchmarkSettings& settings, const vector<BenchmarkRecord>& records)
+{
+    output << "{\n  \"inputs\": " << settings.generator.inputs
+        << ",\n  \"outputs\": " << settings.generator.outputs
+        << ",\n  \"unreachable\": " << settings.generator.unreachable
+        << ",\n  \"seed\": " << settings.generator.seed
+        << ",\n  \"engine\": \"" << settings.engine << "\""
+        << ",\n  \"threads\": " << settings.threads
+        << ",\n  \"repeat\": " << settings.repeat
+        << ",\n  \"results\": [";
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const auto& record = records[i];
+        output << (i == 0 ? "\n" : ",\n")
+            << "    {\"kind\": \"" << record.kind << "\", \"states\": " << record.states
+            << ", \"classes\": " << record.classes << ", \"phase\": \"" << record.phase
+            << "\", \"milliseconds\": " << record.milliseconds << ", \"result_states\": " << record.resultStates << "}";
+    }
+    output << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[])
+{
+    CommandLine commandLine = parseCommandLine(argc, argv);
+    string kind = commandLine.option("kind", "both");
+    string format = commandLine.option("format", "csv");
+    BenchmarkSettings settings;
+    settings.engine = commandLine.option("engine", ENGINE_ROUNDS);
+
+    if (!commandLine.args.empty() || (kind != "mealy" && kind != "moore" && kind != "both")
+        || (format != "csv" && format != "json") || !isKnownEngine(settings.engine))
+    {
+        cout << "Usage: " << argv[0] << " [--kind=mealy|moore|both] [--min-states=N] [--max-states=N]"
+            << " [--inputs=N] [--outputs=N] [--classes=N] [--unreachable=F] [--seed=N]"
+            << " [--engine=rounds|hopcroft|parallel] [--threads=N] [--repeat=N]"
+            << " [--format=csv|json] [--out=<file>] [--work-dir=<dir>]\n"
+            << "Sizes grow tenfold from --min-states (100) to --max-states (10000000);"
+            << " --classes defaults to a quarter of the states." << endl;
+        return 1;
+    }
+
+    try
+    {
+        settings.kinds = kind == "both" ? vector<string>{ "mealy", "moore" } : vector<string>{ kind };
+        size_t minStates = stoul(commandLine.option("min-states", "100"));
+        size_t maxStates = stoul(commandLine.option("max-states", "10000000"));
+        for (size_t states = max<size_t>(1, minStates); states <= maxStates; states *= 10)
+        {
+            settings.sizes.push_back(states);
+        }
+        settings.generator.inputs = stoul(commandLine.option("inputs", "4"));
+        settings.generator.outputs = stoul(commandLine.option("outputs", "4"));
+        settings.generator.unreachable = stod(commandLine.option("unreachable", "0.1"));
+        settings.generator.seed = stoull(commandLine.option("seed", "1"));
+        settings.classes = stoul(commandLine.option("classes", "0"));
+        settings.threads = stoul(commandLine.option("threads", "0"));
+        settings.repeat = max<size_t>(1, stoul(commandLine.option("repeat", "1")));
+        settings.workDir = commandLine.option("work-dir", fs::temp_directory_path().string());
+
+        ThreadPool ownPool(settings.threads == 0 ? 0 : settings.threads - 1);
+        ThreadPool& pool = settings.threads == 0 ? ThreadPool::instance() : ownPool;
+        settings.threads = pool.concurrency();
+
+        vector<BenchmarkRecord> records;
+        for (size_t states : settings.sizes)
+        {
+            for (const auto& name : settings.kinds)
+            {
+                if (name == "mealy")
+                {
+                    BenchmarkKind<MealyTable, MooreTable>(settings, name, states, pool, records);
+                }
+                else
+                {
+                    BenchmarkKind<MooreTable, MealyTable>(settings, name, states, pool, records);
+                }
+            }
+        }
+
+        string outFileName = commandLine.option("out");
+        ofstream outFile;
+        if (!outFileName.empty())
+        {
+            outFile.open(outFileName);
+            if (!outFile)
+            {
+                throw runtime_error("Cannot open output file: " + outFileName);
+            }
+        }
+        ostream& output = outFileName.empty() ? cout : outFile;
+        if (format == "json")
+        {
+            WriteJson(output, settings, records);
+        }
+        else
+        {
+            WriteCsv(output, settings, records);
+        }
+    }
+    catch (const exception& e)
+    {
+        cerr << "Ошибка: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "CommandLine.h"
+#include "Server.h"
+
+using namespace std;
+
+// Клиент для проверки сервера (Minimize serve): отправляет один запрос, тело берётся
+// из файла --body или из стандартного ввода с --stdin. С --repeat=N запрос повторяется
+// по тому же соединению и печатается число запросов в секунду.
+
+string ReadBody(const CommandLine& commandLine)
+{
+    if (commandLine.has("stdin"))
+    {
+        return string(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+    }
+    string bodyFileName = commandLine.option("body");
+    if (bodyFileName.empty())
+    {
+        return "";
+    }
+    ifstream bodyFile(bodyFileName, ios::binary);
+    if (!bodyFile)
+    {
+        throw runtime_error("Cannot open body file: " + bodyFileName);
+    }
+    ostringstream body;
+    body << bodyFile.rdbuf();
+    return body.str();
+}
+
+int main(int argc, char* argv[])
+{
+    CommandLine commandLine = parseCommandLine(argc, argv);
+    if (commandLine.args.size() < 2)
+    {
+        cout << "Usage: " << argv[0] << " <socket> <command> [<args>...] [--body=<file>|--stdin] [--repeat=N]\n"
+            << "Commands: load <id> <mealy|moore> [<file>], unload <id>, list, get <id>,"
+            << " minimize <id> <result-id>, convert <id> <result-id>, run <id>, equiv <id> <state> <state>,"
+            << " shutdown" << endl;
+        return 1;
+    }
+
+    try
+    {
+        string request = commandLine.args[1];
+        for (size_t i = 2; i < commandLine.args.size(); i++)
+        {
+            request += " " + commandLine.args[i];
+        }
+        request += "\n" + ReadBody(commandLine);
+        size_t repeat = max<size_t>(1, stoul(commandLine.option("repeat", "1")));
+
+        int fd = connectUnixSocket(commandLine.args[0]);
+        string response;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < repeat; i++)
+        {
+            writeFrame(fd, request);
+            if (!readFrame(fd, response))
+            {
+                closeSocket(fd);
+                throw runtime_error("Server closed the connection");
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        closeSocket(fd);
+
+        size_t lineEnd = response.find('\n');
+        string status = response.substr(0, lineEnd);
+        string body = lineEnd == string::npos ? string() : response.substr(lineEnd + 1);
+        cerr << status << "\n";
+        cout << body;
+        if (repeat > 1)
+        {
+            cerr << repeat << " requests in " << seconds * 1000 << " ms, " << repeat / seconds << " requests/s\n";
+        }
+        return status.rfind("OK", 0) == 0 ? 0 : 1;
+    }
+    catch (const exception& e)
+    {
+        cerr << "Ошибка: " << e.what() << endl;
+        return 1;
+    }
+}
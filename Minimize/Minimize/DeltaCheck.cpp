@@ -0,0 +1,189 @@
+﻿#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Automaton.h"
+#include "CommandLine.h"
+#include "CsvWriter.h"
+#include "Generator.h"
+#include "Graph.h"
+#include "Incremental.h"
+#include "Minimization.h"
+#include "OutputFile.h"
+#include "ThreadPool.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Проверка инкрементальной минимизации: случайный автомат, несколько случайных дельт
+// подряд, и после каждой результат repartition по сохранённому разбиению сравнивается
+// с полной минимизацией изменённой таблицы (побайтно, в CSV).
+
+template <typename Table>
+string ToCsv(const Table& table, ThreadPool& pool)
+{
+    ostringstream output;
+    if constexpr (is_same_v<Table, MealyTable>)
+    {
+        writeMealyCsv(output, table, pool);
+    }
+    else
+    {
+        writeMooreCsv(output, table, pool);
+    }
+    return output.str();
+}
+
+template <typename Table>
+Table MinimizeFull(const Table& table, ThreadPool& pool)
+{
+    if constexpr (is_same_v<Table, MealyTable>)
+    {
+        return mealyMin(findMealyReachableStates(table, pool), ENGINE_HOPCROFT, pool);
+    }
+    else
+    {
+        return mooreMin(findMooreReachableStates(table, pool), ENGINE_HOPCROFT, pool);
+    }
+}
+
+// То же, что minimizeIncremental в Minimize.cpp, но разбиение хранится в памяти:
+// partition заменяется разбиением изменённой таблицы.
+template <typename Table>
+Table MinimizeDelta(const Table& table, vector<uint32_t>& partition, const vector<char>& changed, ThreadPool& pool)
+{
+    vector<StateId> reachable = findReachable(table.next, table.stateCount(), table.inputCount(), pool);
+    vector<uint32_t> blocks = repartition(table, reachable, partition, changed);
+    uint32_t blockCount = blocks.empty() ? 0 : *max_element(blocks.begin(), blocks.end()) + 1;
+
+    partition.assign(table.stateCount(), NO_STATE);
+    for (size_t i = 0; i < reachable.size(); i++)
+    {
+        partition[reachable[i]] = blocks[i];
+    }
+    return buildQuotient(table, partition, blockCount);
+}
+
+// От одной до трёх строк дельты; примерно каждый десятый переход становится неопределённым.
+template <typename Table>
+void WriteRandomDelta(const Table& table, mt19937_64& random, const string& fileName)
+{
+    constexpr bool isMealy = is_same_v<Table, MealyTable>;
+    size_t stateCount = table.stateCount();
+    ofstream output(fileName);
+    for (size_t line = 0, lines = 1 + random() % 3; line < lines; line++)
+    {
+        const string& state = table.states.names[random() % stateCount];
+        const string& symbol = table.outputs.names[random() % table.outputs.size()];
+        if (!isMealy && random() % 10 < 3)
+        {
+            output << state << ";;" << symbol << '\n';
+            continue;
+        }
+        output << state << ';' << table.inputs.names[random() % table.inputCount()] << ';';
+        if (random() % 10 == 0)
+        {
+            output << UNDEFINED_NAME;
+        }
+        else
+        {
+            output << table.states.names[random() % stateCount];
+            if (isMealy)
+            {
+                output << '/' << symbol;
+            }
+        }
+        output << '\n';
+    }
+    if (!output.flush())
+    {
+        throw runtime_error("Cannot write delta file " + fileName);
+    }
+}
+
+// Возвращает число дельт, после которых результаты разошлись.
+template <typename Table>
+size_t CheckMachine(const string& kind, uint64_t seed, size_t deltas, const string& deltaFileName, ThreadPool& pool)
+{
+    mt19937_64 random(seed);
+    GeneratorOptions options;
+    options.states = 2 + random() % 300;
+    options.inputs = 1 + random() % 4;
+    options.outputs = 2;
+    options.classes = 1 + random() % max<size_t>(1, options.states / 4);
+    options.unreachable = random() % 2 == 0 ? 0 : 0.2;
+    options.seed = seed;
+
+    Table table;
+    if constexpr (is_same_v<Table, MealyTable>)
+    {
+        table = generateMealy(options);
+    }
+    else
+    {
+        table = generateMoore(options);
+    }
+
+    vector<uint32_t> partition;
+    MinimizeDelta(table, partition, {}, pool);
+    size_t failed = 0;
+    for (size_t delta = 0; delta < deltas; delta++)
+    {
+        WriteRandomDelta(table, random, deltaFileName);
+        vector<char> changed = applyDelta(table, deltaFileName);
+        if (ToCsv(MinimizeDelta(table, partition, changed, pool), pool) != ToCsv(MinimizeFull(table, pool), pool))
+        {
+            cout << "MISMATCH " << kind << " seed=" << seed << " delta=" << delta << "\n";
+            failed++;
+        }
+    }
+    return failed;
+}
+
+int main(int argc, char* argv[])
+{
+    CommandLine commandLine = parseCommandLine(argc, argv);
+    if (!commandLine.args.empty())
+    {
+        cout << "Usage: " << argv[0] << " [--machines=N] [--deltas=N] [--seed=N] [--threads=N]\n"
+            << "Machines alternate between Mealy and Moore; machine i is generated from seed + i." << endl;
+        return 1;
+    }
+
+    string deltaFileName = (fs::temp_directory_path() / ("minimize-delta-check-" + uniqueFileSuffix() + ".csv")).string();
+    size_t failed = 0;
+    try
+    {
+        size_t machines = stoul(commandLine.option("machines", "500"));
+        size_t deltas = stoul(commandLine.option("deltas", "3"));
+        uint64_t seed = stoull(commandLine.option("seed", "1"));
+        size_t threads = stoul(commandLine.option("threads", "0"));
+
+        ThreadPool ownPool(threads == 0 ? 0 : threads - 1);
+        ThreadPool& pool = threads == 0 ? ThreadPool::instance() : ownPool;
+
+        for (size_t i = 0; i < machines; i++)
+        {
+            failed += i % 2 == 0
+                ? CheckMachine<MealyTable>("mealy", seed + i, deltas, deltaFileName, pool)
+                : CheckMachine<MooreTable>("moore", seed + i, deltas, deltaFileName, pool);
+        }
+        cout << "Delta check: " << machines << " machines, " << machines * deltas << " deltas, "
+            << failed << " mismatched" << endl;
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what() << endl;
+        failed = 1;
+    }
+
+    error_code error;
+    fs::remove(deltaFileName, error);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+﻿#pragma once
+#include <cstdint>
+
+// Перемешивание значения в накапливаемый хеш (как boost::hash_combine, 64 бита).
+// Общая для сигнатур состояний и столбцов входов.
+inline uint64_t mixHash(uint64_t hash, uint64_t value)
+{
+    hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
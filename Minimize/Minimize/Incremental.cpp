@@ -0,0 +1,777 @@
+﻿#include "Incremental.h"
+#include "MappedFile.h"
+#include "OutputFile.h"
+#include "PartitionRefinement.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std;
+
+namespace
+{
+    struct PartitionHeader
+    {
+        char magic[4];
+        uint32_t version;
+        AutomatonKind kind;
+        uint32_t stateCount;
+        uint64_t fingerprint;
+    };
+
+    // FNV-1a: отпечаток нужен только для того, чтобы не применить разбиение к чужому автомату.
+    class Fnv
+    {
+    public:
+        void bytes(const void* data, size_t size)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                m_hash = (m_hash ^ p[i]) * 0x100000001B3ull;
+            }
+        }
+
+        void number(uint64_t value) { bytes(&value, sizeof(value)); }
+
+        void names(const NameTable& table)
+        {
+            number(table.size());
+            for (const auto& name : table.names)
+            {
+                number(name.size());
+                bytes(name.data(), name.size());
+            }
+        }
+
+        void ids(const vector<uint32_t>& values)
+        {
+            number(values.size());
+            bytes(values.data(), values.size() * sizeof(uint32_t));
+        }
+
+        uint64_t value() const { return m_hash; }
+
+    private:
+        uint64_t m_hash = 0xCBF29CE484222325ull;
+    };
+
+    template <typename Table>
+    uint64_t tableFingerprint(const Table& table)
+    {
+        Fnv fnv;
+        fnv.names(table.states);
+        fnv.names(table.inputs);
+        fnv.names(table.outputs);
+        fnv.ids(table.next);
+        fnv.ids(table.out);
+        return fnv.value();
+    }
+
+    // Строки дельты: поля через ';', без заголовка; пустые строки пропускаются.
+    template <typename OnLine>
+    void forEachDeltaLine(const string& fileName, const OnLine& onLine)
+    {
+        MappedFile file(fileName);
+        string_view data = file.view();
+        if (data.substr(0, 3) == "\xEF\xBB\xBF")
+        {
+            data.remove_prefix(3);
+        }
+
+        size_t lineNumber = 0;
+        while (!data.empty())
+        {
+            size_t lineEnd = data.find('\n');
+            string_view line = data.substr(0, lineEnd);
+            data.remove_prefix(lineEnd == string_view::npos ? data.size() : lineEnd + 1);
+            lineNumber++;
+
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+            if (line.empty())
+            {
+                continue;
+            }
+
+            string_view fields[3];
+            for (size_t i = 0; i < 3; i++)
+            {
+                size_t separator = i < 2 ? line.find(';') : string_view::npos;
+                if (i < 2 && separator == string_view::npos)
+                {
+                    throw runtime_error("Invalid delta line " + to_string(lineNumber) + " in " + fileName);
+                }
+                fields[i] = line.substr(0, separator);
+                line.remove_prefix(separator == string_view::npos ? line.size() : separator + 1);
+            }
+            onLine(fields[0], fields[1], fields[2], lineNumber);
+        }
+    }
+
+    uint32_t findInDelta(const NameTable& table, string_view name, const char* what, size_t lineNumber)
+    {
+        uint32_t id = table.find(name);
+        if (id == NO_STATE)
+        {
+            throw runtime_error("Unknown " + string(what) + " " + string(name) + " in delta line " + to_string(lineNumber));
+        }
+        return id;
+    }
+
+    StateId deltaTarget(const NameTable& states, string_view name, size_t lineNumber)
+    {
+        return name.empty() || name == UNDEFINED_NAME ? NO_STATE : findInDelta(states, name, "state", lineNumber);
+    }
+
+    // Выходы вершины сжатого автомата берутся у её представителя.
+    void appendOutputs(const MealyTable& mealy, StateId state, vector<uint32_t>& out)
+    {
+        size_t inputCount = mealy.inputCount();
+        out.insert(out.end(), mealy.out.begin() + state * inputCount, mealy.out.begin() + (state + 1) * inputCount);
+    }
+
+    void appendOutputs(const MooreTable& moore, StateId state, vector<uint32_t>& out)
+    {
+        out.push_back(moore.out[state]);
+    }
+
+    vector<uint32_t> initialBlocks(const MealyTable&, size_t stateCount, size_t inputCount,
+        const vector<uint32_t>& next, const vector<uint32_t>& out)
+    {
+        return mealyInitialBlocks(stateCount, inputCount, next, out);
+    }
+
+    vector<uint32_t> initialBlocks(const MooreTable&, size_t stateCount, size_t inputCount,
+        const vector<uint32_t>& next, const vector<uint32_t>& out)
+    {
+        return mooreInitialBlocks(stateCount, inputCount, next, out);
+    }
+
+    // Затронутые состояния: те, из которых достижимо изменённое состояние
+    // или состояние без блока в предыдущем разбиении.
+    vector<char> findAffected(const vector<StateId>& next, size_t stateCount, size_t inputCount,
+        const vector<StateId>& reachable, const vector<uint32_t>& previous, const vector<char>& changed)
+    {
+        vector<char> affected(stateCount, 0);
+        vector<StateId> queue;
+        for (auto s : reachable)
+        {
+            if ((s < changed.size() && changed[s]) || s >= previous.size() || previous[s] == NO_STATE)
+            {
+                affected[s] = 1;
+                queue.push_back(s);
+            }
+        }
+        if (queue.empty() || queue.size() == reachable.size())
+        {
+            return affected;
+        }
+
+        // Обратные рёбра между достижимыми состояниями в формате CSR.
+        vector<uint32_t> offsets(stateCount + 1, 0);
+        for (auto s : reachable)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                StateId t = next[size_t(s) * inputCount + a];
+                if (t != NO_STATE)
+                {
+                    offsets[t + 1]++;
+                }
+            }
+        }
+        for (size_t s = 0; s < stateCount; s++)
+        {
+            offsets[s + 1] += offsets[s];
+        }
+        vector<StateId> sources(offsets.back());
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (auto s : reachable)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                StateId t = next[size_t(s) * inputCount + a];
+                if (t != NO_STATE)
+                {
+                    sources[fill[t]++] = s;
+                }
+            }
+        }
+
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            StateId t = queue[head];
+            for (uint32_t e = offsets[t]; e < offsets[t + 1]; e++)
+            {
+                if (!affected[sources[e]])
+                {
+                    affected[sources[e]] = 1;
+                    queue.push_back(sources[e]);
+                }
+            }
+        }
+        return affected;
+    }
+
+    // Сжатый автомат: вершинами служат старые блоки незатронутых состояний
+    // и отдельные затронутые состояния. out хранит outStride выходов на вершину.
+    struct ReducedMachine
+    {
+        size_t nodeCount = 0;
+        size_t inputCount = 0;
+        size_t outStride = 0;
+        vector<uint32_t> next;
+        vector<uint32_t> out;
+        vector<char> affected;
+        vector<uint32_t> nodeOf;
+
+        // Совпадают ли выходы и набор определённых переходов двух вершин.
+        bool sameOutputs(uint32_t first, uint32_t second) const
+        {
+            for (size_t i = 0; i < outStride; i++)
+            {
+                if (out[first * outStride + i] != out[second * outStride + i])
+                {
+                    return false;
+                }
+            }
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                if ((next[first * inputCount + a] == NO_STATE) != (next[second * inputCount + a] == NO_STATE))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    template <typename Table>
+    ReducedMachine buildReducedMachine(const Table& table, const vector<StateId>& reachable,
+        const vector<uint32_t>& previous, const vector<char>& affectedStates)
+    {
+        ReducedMachine machine;
+        machine.inputCount = table.inputCount();
+
+        // Незатронутые состояния одного старого блока эквивалентны и в новом автомате,
+        // а их преемники тоже не затронуты, поэтому блок сворачивается в одну вершину.
+        uint32_t previousBlockCount = 0;
+        for (auto s : reachable)
+        {
+            if (!affectedStates[s])
+            {
+                previousBlockCount = max(previousBlockCount, previous[s] + 1);
+            }
+        }
+
+        machine.nodeOf.assign(table.stateCount(), NO_STATE);
+        vector<uint32_t> blockNode(previousBlockCount, NO_STATE);
+        vector<StateId> representatives;
+        for (auto s : reachable)
+        {
+            uint32_t& node = affectedStates[s] ? machine.nodeOf[s] : blockNode[previous[s]];
+            if (node == NO_STATE)
+            {
+                node = uint32_t(representatives.size());
+                representatives.push_back(s);
+                machine.affected.push_back(affectedStates[s]);
+            }
+            machine.nodeOf[s] = node;
+        }
+
+        size_t inputCount = machine.inputCount;
+        machine.nodeCount = representatives.size();
+        machine.next.resize(machine.nodeCount * inputCount);
+        for (size_t node = 0; node < machine.nodeCount; node++)
+        {
+            StateId representative = representatives[node];
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                StateId t = table.next[size_t(representative) * inputCount + a];
+                machine.next[node * inputCount + a] = t == NO_STATE ? NO_STATE : machine.nodeOf[t];
+            }
+            appendOutputs(table, representative, machine.out);
+        }
+        machine.outStride = machine.nodeCount == 0 ? 0 : machine.out.size() / machine.nodeCount;
+        return machine;
+    }
+
+    constexpr uint32_t UNMATCHED = NO_STATE - 1;
+
+    // Ищет для каждой затронутой вершины эквивалентную ей вершину-блок (или NO_STATE).
+    // Кандидаты получаются обратным ходом по кратчайшему пути до первой незатронутой
+    // вершины, затем каждый проверяется совместным обходом пар. Возвращает false,
+    // если из какой-то затронутой вершины незатронутые недостижимы или кандидатов
+    // слишком много или переходов не меньше 2^32; тогда сжатый автомат разбивается целиком.
+    bool matchAffected(const ReducedMachine& machine, vector<uint32_t>& match)
+    {
+        size_t nodeCount = machine.nodeCount;
+        size_t inputCount = machine.inputCount;
+        const vector<uint32_t>& next = machine.next;
+
+        vector<uint32_t> affectedNodes;
+        for (uint32_t node = 0; node < nodeCount; node++)
+        {
+            if (machine.affected[node])
+            {
+                affectedNodes.push_back(node);
+            }
+        }
+        if (affectedNodes.size() == nodeCount)
+        {
+            return false;
+        }
+        // Номера рёбер v * inputCount + a и смещения ниже 32-битные.
+        if (uint64_t(nodeCount) * inputCount >= NO_STATE)
+        {
+            return false;
+        }
+
+        // hop[v] — вход, по которому из v ближе всего до незатронутой вершины.
+        vector<uint32_t> hop(nodeCount, NO_STATE);
+        vector<uint32_t> order;
+        for (auto v : affectedNodes)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t t = next[v * inputCount + a];
+                if (t != NO_STATE && !machine.affected[t])
+                {
+                    hop[v] = uint32_t(a);
+                    order.push_back(v);
+                    break;
+                }
+            }
+        }
+
+        // Обратные рёбра между затронутыми вершинами; хранится номер ребра v * inputCount + a.
+        vector<uint32_t> offsets(nodeCount + 1, 0);
+        for (auto v : affectedNodes)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t t = next[v * inputCount + a];
+                if (t != NO_STATE && machine.affected[t])
+                {
+                    offsets[t + 1]++;
+                }
+            }
+        }
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        vector<uint32_t> edges(offsets.back());
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (auto v : affectedNodes)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t t = next[v * inputCount + a];
+                if (t != NO_STATE && machine.affected[t])
+                {
+                    edges[fill[t]++] = uint32_t(v * inputCount + a);
+                }
+            }
+        }
+
+        for (size_t head = 0; head < order.size(); head++)
+        {
+            uint32_t t = order[head];
+            for (uint32_t e = offsets[t]; e < offsets[t + 1]; e++)
+            {
+                uint32_t v = uint32_t(edges[e] / inputCount);
+                if (hop[v] == NO_STATE)
+                {
+                    hop[v] = uint32_t(edges[e] % inputCount);
+                    order.push_back(v);
+                }
+            }
+        }
+        if (order.size() != affectedNodes.size())
+        {
+            return false;
+        }
+
+        // Обратные переходы между незатронутыми вершинами: для входа a и вершины t
+        // все u, где next(u, a) = t.
+        vector<uint32_t> inverseOffsets(inputCount * nodeCount + 1, 0);
+        for (uint32_t u = 0; u < nodeCount; u++)
+        {
+            for (size_t a = 0; !machine.affected[u] && a < inputCount; a++)
+            {
+                uint32_t t = next[u * inputCount + a];
+                if (t != NO_STATE)
+                {
+                    inverseOffsets[a * nodeCount + t + 1]++;
+                }
+            }
+        }
+        for (size_t i = 1; i < inverseOffsets.size(); i++)
+        {
+            inverseOffsets[i] += inverseOffsets[i - 1];
+        }
+        vector<uint32_t> inverseSources(inverseOffsets.back());
+        vector<uint32_t> inverseFill(inverseOffsets.begin(), inverseOffsets.end() - 1);
+        for (uint32_t u = 0; u < nodeCount; u++)
+        {
+            for (size_t a = 0; !machine.affected[u] && a < inputCount; a++)
+            {
+                uint32_t t = next[u * inputCount + a];
+                if (t != NO_STATE)
+                {
+                    inverseSources[inverseFill[a * nodeCount + t]++] = u;
+                }
+            }
+        }
+
+        // Кандидаты вершины v: незатронутые u с теми же выходами, с теми же переходами
+        // в незатронутые вершины и с переходом по hop[v] в кандидата преемника.
+        vector<uint32_t> candidateBegin(nodeCount, 0);
+        vector<uint32_t> candidateEnd(nodeCount, 0);
+        vector<uint32_t> candidates;
+        size_t candidateLimit = 4 * nodeCount + 1024;
+        for (auto v : order)
+        {
+            uint32_t a = hop[v];
+            uint32_t t = next[v * inputCount + a];
+            uint32_t from = machine.affected[t] ? candidateBegin[t] : 0;
+            uint32_t to = machine.affected[t] ? candidateEnd[t] : 1;
+
+            candidateBegin[v] = uint32_t(candidates.size());
+            for (uint32_t c = from; c < to; c++)
+            {
+                uint32_t target = machine.affected[t] ? candidates[c] : t;
+                for (uint32_t e = inverseOffsets[a * nodeCount + target]; e < inverseOffsets[a * nodeCount + target + 1]; e++)
+                {
+                    uint32_t u = inverseSources[e];
+                    bool fits = machine.sameOutputs(v, u);
+                    for (size_t b = 0; fits && b < inputCount; b++)
+                    {
+                        uint32_t exit = next[v * inputCount + b];
+                        fits = exit == NO_STATE || machine.affected[exit] || next[u * inputCount + b] == exit;
+                    }
+                    if (fits)
+                    {
+                        candidates.push_back(u);
+                    }
+                }
+            }
+            candidateEnd[v] = uint32_t(candidates.size());
+            if (candidates.size() > candidateLimit)
+            {
+                return false;
+            }
+        }
+
+        // Совместный обход пар (затронутая вершина, вершина-блок). Если он не встретил
+        // противоречий, все пройденные пары эквивалентны.
+        match.assign(nodeCount, UNMATCHED);
+        vector<uint32_t> pairing(nodeCount, NO_STATE);
+        vector<uint32_t> explored;
+        vector<pair<uint32_t, uint32_t>> stack;
+        auto check = [&](uint32_t root, uint32_t candidate)
+        {
+            bool equivalent = true;
+            stack.emplace_back(root, candidate);
+            while (!stack.empty() && equivalent)
+            {
+                auto [v, u] = stack.back();
+                stack.pop_back();
+                if (match[v] != UNMATCHED || pairing[v] != NO_STATE)
+                {
+                    equivalent = (match[v] != UNMATCHED ? match[v] : pairing[v]) == u;
+                    continue;
+                }
+                pairing[v] = u;
+                explored.push_back(v);
+                equivalent = machine.sameOutputs(v, u);
+                for (size_t a = 0; equivalent && a < inputCount; a++)
+                {
+                    uint32_t t = next[v * inputCount + a];
+                    uint32_t tu = next[u * inputCount + a];
+                    if (t == NO_STATE)
+                    {
+                        continue;
+                    }
+                    if (machine.affected[t])
+                    {
+                        stack.emplace_back(t, tu);
+                    }
+                    else
+                    {
+                        equivalent = t == tu;
+                    }
+                }
+            }
+            for (auto v : explored)
+            {
+                if (equivalent)
+                {
+                    match[v] = pairing[v];
+                }
+                pairing[v] = NO_STATE;
+            }
+            explored.clear();
+            stack.clear();
+            return equivalent;
+        };
+
+        for (auto v : affectedNodes)
+        {
+            for (uint32_t c = candidateBegin[v]; c < candidateEnd[v] && match[v] == UNMATCHED; c++)
+            {
+                check(v, candidates[c]);
+            }
+            if (match[v] == UNMATCHED)
+            {
+                match[v] = NO_STATE;
+            }
+        }
+        return true;
+    }
+
+    // Разбиение затронутых вершин, не эквивалентных ни одному блоку. Переходы из них
+    // в блоки (или в вершины, совпавшие с блоками) ведут в вершины-тупики, каждая
+    // в своём начальном классе. Возвращает класс для каждой такой вершины.
+    template <typename Table>
+    vector<uint32_t> refineUnmatched(const Table& table, const ReducedMachine& machine,
+        const vector<uint32_t>& match, const vector<uint32_t>& unmatched)
+    {
+        size_t inputCount = machine.inputCount;
+        vector<uint32_t> localId(machine.nodeCount, NO_STATE);
+        for (uint32_t i = 0; i < unmatched.size(); i++)
+        {
+            localId[unmatched[i]] = i;
+        }
+
+        vector<uint32_t> next;
+        vector<uint32_t> out;
+        vector<uint32_t> terminals;
+        for (auto v : unmatched)
+        {
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t t = machine.next[v * inputCount + a];
+                if (t != NO_STATE && machine.affected[t] && match[t] != NO_STATE)
+                {
+                    t = match[t];
+                }
+                if (t != NO_STATE && localId[t] == NO_STATE)
+                {
+                    localId[t] = uint32_t(unmatched.size() + terminals.size());
+                    terminals.push_back(t);
+                }
+                next.push_back(t == NO_STATE ? NO_STATE : localId[t]);
+            }
+            out.insert(out.end(), machine.out.begin() + v * machine.outStride,
+                machine.out.begin() + (v + 1) * machine.outStride);
+        }
+        next.resize((unmatched.size() + terminals.size()) * inputCount, NO_STATE);
+        out.resize((unmatched.size() + terminals.size()) * machine.outStride, 0);
+
+        size_t localCount = unmatched.size() + terminals.size();
+        vector<uint32_t> initial = initialBlocks(table, localCount, inputCount, next, out);
+        uint32_t terminalBlock = 0;
+        for (size_t i = 0; i < unmatched.size(); i++)
+        {
+            terminalBlock = max(terminalBlock, initial[i] + 1);
+        }
+        for (size_t i = unmatched.size(); i < localCount; i++)
+        {
+            initial[i] = terminalBlock++;
+        }
+
+        vector<uint32_t> blocks = refineHopcroft(localCount, inputCount, next, initial);
+        blocks.resize(unmatched.size());
+        return blocks;
+    }
+
+    template <typename Table>
+    vector<uint32_t> repartitionTable(const Table& table, const vector<StateId>& reachable,
+        const vector<uint32_t>& previous, const vector<char>& changed)
+    {
+        vector<char> affected = findAffected(table.next, table.stateCount(), table.inputCount(),
+            reachable, previous, changed);
+        ReducedMachine machine = buildReducedMachine(table, reachable, previous, affected);
+
+        // Метка вершины: номер вершины-блока, которой она эквивалентна,
+        // или nodeCount + класс среди остальных затронутых вершин.
+        vector<uint32_t> labels(machine.nodeCount);
+        vector<uint32_t> match;
+        if (matchAffected(machine, match))
+        {
+            vector<uint32_t> unmatched;
+            for (uint32_t v = 0; v < machine.nodeCount; v++)
+            {
+                if (machine.affected[v] && match[v] == NO_STATE)
+                {
+                    unmatched.push_back(v);
+                }
+                labels[v] = machine.affected[v] ? match[v] : v;
+            }
+            vector<uint32_t> classes = refineUnmatched(table, machine, match, unmatched);
+            for (size_t i = 0; i < unmatched.size(); i++)
+            {
+                labels[unmatched[i]] = uint32_t(machine.nodeCount + classes[i]);
+            }
+        }
+        else
+        {
+            labels = refineHopcroft(machine.nodeCount, machine.inputCount, machine.next,
+                initialBlocks(table, machine.nodeCount, machine.inputCount, machine.next, machine.out));
+        }
+
+        vector<uint32_t> blocks(reachable.size());
+        for (size_t i = 0; i < reachable.size(); i++)
+        {
+            blocks[i] = labels[machine.nodeOf[reachable[i]]];
+        }
+        canonicalizeBlocks(blocks);
+        return blocks;
+    }
+}
+
+uint64_t fingerprint(const MealyTable& mealy)
+{
+    return tableFingerprint(mealy);
+}
+
+uint64_t fingerprint(const MooreTable& moore)
+{
+    return tableFingerprint(moore);
+}
+
+bool loadPartition(const string& fileName, AutomatonKind kind, SavedPartition& partition)
+{
+    ifstream input(fileName, ios::binary);
+    PartitionHeader header = {};
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || memcmp(header.magic, PARTITION_MAGIC, sizeof(header.magic)) != 0
+        || header.version != PARTITION_VERSION || header.kind != kind)
+    {
+        return false;
+    }
+
+    // Размер сверяется до выделения памяти: испорченный заголовок не должен заставить выделить 16 ГиБ.
+    error_code error;
+    uint64_t fileSize = filesystem::file_size(fileName, error);
+    if (error || fileSize != sizeof(header) + uint64_t(header.stateCount) * sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    partition.fingerprint = header.fingerprint;
+    partition.blocks.resize(header.stateCount);
+    if (!input.read(reinterpret_cast<char*>(partition.blocks.data()),
+        streamsize(partition.blocks.size() * sizeof(uint32_t))))
+    {
+        partition.blocks.clear();
+        return false;
+    }
+    // repartition индексирует массивы номерами блоков.
+    for (uint32_t block : partition.blocks)
+    {
+        if (block != NO_STATE && block >= header.stateCount)
+        {
+            partition.blocks.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void savePartition(const string& fileName, AutomatonKind kind, const SavedPartition& partition)
+{
+    OutputFile file(fileName, ios::binary);
+    if (!file.is_open())
+    {
+        throw runtime_error("Cannot write partition file " + fileName);
+    }
+    ofstream& output = file.stream();
+
+    PartitionHeader header = {};
+    memcpy(header.magic, PARTITION_MAGIC, sizeof(header.magic));
+    header.version = PARTITION_VERSION;
+    header.kind = kind;
+    header.stateCount = uint32_t(partition.blocks.size());
+    header.fingerprint = partition.fingerprint;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(partition.blocks.data()),
+        streamsize(partition.blocks.size() * sizeof(uint32_t)));
+    if (!file.commit())
+    {
+        throw runtime_error("Cannot write partition file " + fileName);
+    }
+}
+
+vector<char> applyDelta(MealyTable& mealy, const string& fileName)
+{
+    vector<char> changed(mealy.stateCount(), 0);
+    forEachDeltaLine(fileName, [&](string_view stateField, string_view inputField, string_view cell, size_t lineNumber)
+    {
+        StateId state = findInDelta(mealy.states, stateField, "state", lineNumber);
+        SymbolId input = findInDelta(mealy.inputs, inputField, "input", lineNumber);
+        size_t index = size_t(state) * mealy.inputCount() + input;
+
+        StateId target = NO_STATE;
+        string_view output = UNDEFINED_NAME;
+        if (!cell.empty() && cell != UNDEFINED_NAME)
+        {
+            size_t slash = cell.find('/');
+            if (slash == string_view::npos)
+            {
+                throw runtime_error("Invalid transition format in delta line " + to_string(lineNumber));
+            }
+            target = deltaTarget(mealy.states, cell.substr(0, slash), lineNumber);
+            if (slash + 1 < cell.size())
+            {
+                output = cell.substr(slash + 1);
+            }
+        }
+
+        mealy.next[index] = target;
+        mealy.out[index] = mealy.outputs.intern(output);
+        changed[state] = 1;
+    });
+    return changed;
+}
+
+vector<char> applyDelta(MooreTable& moore, const string& fileName)
+{
+    vector<char> changed(moore.stateCount(), 0);
+    forEachDeltaLine(fileName, [&](string_view stateField, string_view inputField, string_view cell, size_t lineNumber)
+    {
+        StateId state = findInDelta(moore.states, stateField, "state", lineNumber);
+        if (inputField.empty())
+        {
+            moore.out[state] = moore.outputs.intern(cell);
+        }
+        else
+        {
+            SymbolId input = findInDelta(moore.inputs, inputField, "input", lineNumber);
+            moore.next[size_t(state) * moore.inputCount() + input] = deltaTarget(moore.states, cell, lineNumber);
+        }
+        changed[state] = 1;
+    });
+    return changed;
+}
+
+vector<uint32_t> repartition(const MealyTable& mealy, const vector<StateId>& reachable,
+    const vector<uint32_t>& previous, const vector<char>& changed)
+{
+    return repartitionTable(mealy, reachable, previous, changed);
+}
+
+vector<uint32_t> repartition(const MooreTable& moore, const vector<StateId>& reachable,
+    const vector<uint32_t>& previous, const vector<char>& changed)
+{
+    return repartitionTable(moore, reachable, previous, changed);
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Automaton.h"
+#include "BinaryFormat.h"
+
+// Инкрементальная минимизация. После каждого запуска рядом с результатом сохраняется
+// разбиение исходного автомата: номер блока каждого состояния (NO_STATE для
+// недостижимых) и отпечаток автомата, по которому разбиение было получено.
+// При следующем запуске к тому же автомату применяется дельта, и пересчитываются
+// только состояния, из которых достижимы изменённые.
+
+constexpr char PARTITION_MAGIC[4] = { 'A', 'U', 'T', 'P' };
+constexpr uint32_t PARTITION_VERSION = 1;
+const std::string PARTITION_EXTENSION = ".partition";
+
+struct SavedPartition
+{
+    uint64_t fingerprint = 0;
+    std::vector<uint32_t> blocks;
+};
+
+uint64_t fingerprint(const MealyTable& mealy);
+uint64_t fingerprint(const MooreTable& moore);
+
+// Возвращает false, если файла нет или он не подходит по виду автомата.
+bool loadPartition(const std::string& fileName, AutomatonKind kind, SavedPartition& partition);
+void savePartition(const std::string& fileName, AutomatonKind kind, const SavedPartition& partition);
+
+// Дельта — CSV без заголовка, по одному изменению в строке:
+//   автомат Мили: состояние;вход;следующее/выход
+//   автомат Мура: состояние;вход;следующее  или  состояние;;выход
+// "-" или пустая ячейка делают переход неопределённым. Возвращает отметки изменённых состояний.
+std::vector<char> applyDelta(MealyTable& mealy, const std::string& fileName);
+std::vector<char> applyDelta(MooreTable& moore, const std::string& fileName);
+
+// Блоки достижимых состояний (в порядке reachable) — то же разбиение, что дала бы
+// полная минимизация. Состояния, из которых не достижимо ни одно изменённое,
+// сохраняют старые блоки; затронутые состояния либо присоединяются к эквивалентному
+// старому блоку, либо разбиваются между собой. Пустое previous означает полный пересчёт.
+std::vector<uint32_t> repartition(const MealyTable& mealy, const std::vector<StateId>& reachable,
+    const std::vector<uint32_t>& previous, const std::vector<char>& changed);
+std::vector<uint32_t> repartition(const MooreTable& moore, const std::vector<StateId>& reachable,
+    const std::vector<uint32_t>& previous, const std::vector<char>& changed);
@@ -0,0 +1,107 @@
+﻿#include "InputClasses.h"
+
+#include <unordered_map>
+
+#include "Hashing.h"
+
+using namespace std;
+
+namespace
+{
+    bool sameColumn(size_t stateCount, size_t inputCount, const vector<StateId>& next, const vector<SymbolId>& out,
+        SymbolId a, SymbolId b)
+    {
+        for (size_t s = 0; s < stateCount; s++)
+        {
+            if (next[s * inputCount + a] != next[s * inputCount + b]
+                || (!out.empty() && out[s * inputCount + a] != out[s * inputCount + b]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+InputClasses findInputClasses(size_t stateCount, size_t inputCount,
+    const vector<StateId>& next, const vector<SymbolId>& out)
+{
+    // Хеши всех столбцов считаются за один проход по строкам таблицы.
+    vector<uint64_t> hashes(inputCount, 0);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            hashes[a] = mixHash(hashes[a], next[s * inputCount + a]);
+            if (!out.empty())
+            {
+                hashes[a] = mixHash(hashes[a], out[s * inputCount + a]);
+            }
+        }
+    }
+
+    // Кандидат в пару каждому столбцу — первый столбец с тем же хешем. Кандидаты проверяются
+    // одним проходом по строкам; столбцы, не совпавшие с кандидатом (коллизия хеша),
+    // сравниваются с классами по одному.
+    vector<SymbolId> candidate(inputCount);
+    unordered_map<uint64_t, SymbolId> firstByHash;
+    for (size_t a = 0; a < inputCount; a++)
+    {
+        candidate[a] = firstByHash.try_emplace(hashes[a], SymbolId(a)).first->second;
+    }
+
+    vector<char> verified(inputCount, 1);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        const StateId* row = next.data() + s * inputCount;
+        const SymbolId* outRow = out.empty() ? nullptr : out.data() + s * inputCount;
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            SymbolId c = candidate[a];
+            if (row[a] != row[c] || (outRow && outRow[a] != outRow[c]))
+            {
+                verified[a] = 0;
+            }
+        }
+    }
+
+    InputClasses classes;
+    classes.classOf.resize(inputCount);
+    for (size_t a = 0; a < inputCount; a++)
+    {
+        SymbolId found = NO_STATE;
+        if (verified[a] && candidate[a] != a)
+        {
+            found = classes.classOf[candidate[a]];
+        }
+        for (SymbolId c = 0; found == NO_STATE && !verified[a] && c < classes.size(); c++)
+        {
+            if (sameColumn(stateCount, inputCount, next, out, classes.representatives[c], SymbolId(a)))
+            {
+                found = c;
+            }
+        }
+        if (found == NO_STATE)
+        {
+            found = SymbolId(classes.representatives.size());
+            classes.representatives.push_back(SymbolId(a));
+        }
+        classes.classOf[a] = found;
+    }
+    return classes;
+}
+
+vector<uint32_t> selectColumns(const vector<uint32_t>& table, size_t stateCount, size_t inputCount,
+    const InputClasses& classes)
+{
+    size_t classCount = classes.size();
+    vector<uint32_t> result(stateCount * classCount);
+    for (size_t s = 0; s < stateCount; s++)
+    {
+        for (size_t c = 0; c < classCount; c++)
+        {
+            result[s * classCount + c] = table[s * inputCount + classes.representatives[c]];
+        }
+    }
+    return result;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Automaton.h"
+
+// Сжатие входного алфавита перед минимизацией. Входы с одинаковыми столбцами
+// таблицы (для каждого состояния тот же переход и, у автомата Мили, тот же выход)
+// объединяются в класс. Разбиение состояний по одному входу из каждого класса
+// совпадает с разбиением по полному алфавиту, поэтому фактор-автомат строится
+// по исходной таблице и содержит все входы.
+
+struct InputClasses
+{
+    // Класс каждого входа; классы пронумерованы в порядке первого входа.
+    std::vector<SymbolId> classOf;
+    // Первый вход каждого класса.
+    std::vector<SymbolId> representatives;
+
+    size_t size() const { return representatives.size(); }
+};
+
+// out — выходы переходов той же формы, что и next, или пустой вектор (автомат Мура).
+InputClasses findInputClasses(size_t stateCount, size_t inputCount,
+    const std::vector<StateId>& next, const std::vector<SymbolId>& out);
+
+// Таблица states × classes.size() из столбцов-представителей таблицы states × inputCount.
+std::vector<uint32_t> selectColumns(const std::vector<uint32_t>& table, size_t stateCount, size_t inputCount,
+    const InputClasses& classes);
@@ -0,0 +1,139 @@
+﻿#include "Minimization.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Diagnostics.h"
+#include "Graph.h"
+#include "InputClasses.h"
+#include "PartitionRefinement.h"
+
+using namespace std;
+
+bool isKnownEngine(const string& engine)
+{
+    return engine == ENGINE_ROUNDS || engine == ENGINE_HOPCROFT || engine == ENGINE_PARALLEL;
+}
+
+MealyTable findMealyReachableStates(const MealyTable& mealy, ThreadPool& pool)
+{
+    return restrictStates(mealy, findReachable(mealy.next, mealy.stateCount(), mealy.inputCount(), pool));
+}
+
+MooreTable findMooreReachableStates(const MooreTable& moore, ThreadPool& pool)
+{
+    return restrictStates(moore, findReachable(moore.next, moore.stateCount(), moore.inputCount(), pool));
+}
+
+SparseMealy findMealyReachableStates(const SparseMealy& mealy)
+{
+    return restrictStates(mealy, findReachable(mealy.offsets, mealy.next));
+}
+
+SparseMoore findMooreReachableStates(const SparseMoore& moore)
+{
+    return restrictStates(moore, findReachable(moore.offsets, moore.next));
+}
+
+namespace
+{
+    void recordInitialBlocks(const vector<uint32_t>& initialBlocks)
+    {
+        // Начальные блоки пронумерованы подряд с нуля.
+        if (RunStats::active() && !initialBlocks.empty())
+        {
+            recordCounter("initial_blocks", *max_element(initialBlocks.begin(), initialBlocks.end()) + 1);
+        }
+    }
+
+    vector<uint32_t> refineSparse(const vector<size_t>& offsets, const vector<SymbolId>& symbols,
+        const vector<StateId>& next, const vector<uint32_t>& initialBlocks, const string& engine, ThreadPool& pool)
+    {
+        recordInitialBlocks(initialBlocks);
+        if (engine == ENGINE_HOPCROFT)
+        {
+            throw runtime_error("Engine " + engine + " does not support sparse tables");
+        }
+        if (engine == ENGINE_PARALLEL)
+        {
+            return refineSparseParallel(offsets, symbols, next, initialBlocks, pool);
+        }
+        return refineSparseRounds(offsets, symbols, next, initialBlocks);
+    }
+}
+
+vector<uint32_t> refine(const vector<StateId>& next, size_t stateCount, size_t inputCount,
+    const vector<uint32_t>& initialBlocks, const string& engine, ThreadPool& pool)
+{
+    recordInitialBlocks(initialBlocks);
+    if (engine == ENGINE_HOPCROFT)
+    {
+        return refineHopcroft(stateCount, inputCount, next, initialBlocks);
+    }
+    if (engine == ENGINE_PARALLEL)
+    {
+        return refineParallel(stateCount, inputCount, next, initialBlocks, pool);
+    }
+    return refineRounds(stateCount, inputCount, next, initialBlocks);
+}
+
+namespace
+{
+    vector<uint32_t> mealyBlocks(const vector<StateId>& next, const vector<SymbolId>& out, size_t stateCount,
+        size_t inputCount, const string& engine, ThreadPool& pool)
+    {
+        vector<uint32_t> initialBlocks = mealyInitialBlocks(stateCount, inputCount, next, out);
+        return refine(next, stateCount, inputCount, initialBlocks, engine, pool);
+    }
+
+    vector<uint32_t> mooreBlocks(const vector<StateId>& next, const vector<SymbolId>& out, size_t stateCount,
+        size_t inputCount, const string& engine, ThreadPool& pool)
+    {
+        vector<uint32_t> initialBlocks = mooreInitialBlocks(stateCount, inputCount, next, out);
+        return refine(next, stateCount, inputCount, initialBlocks, engine, pool);
+    }
+}
+
+// Разбиение строится по сжатому алфавиту (см. InputClasses.h), а фактор-автомат —
+// по исходной таблице, так что в результат попадают все входы.
+MealyTable mealyMin(const MealyTable& mealy, const string& engine, ThreadPool& pool)
+{
+    size_t stateCount = mealy.stateCount();
+    size_t inputCount = mealy.inputCount();
+    InputClasses classes = findInputClasses(stateCount, inputCount, mealy.next, mealy.out);
+    recordAlphabetReduction(inputCount, classes.size());
+
+    vector<uint32_t> blocks = classes.size() == inputCount
+        ? mealyBlocks(mealy.next, mealy.out, stateCount, inputCount, engine, pool)
+        : mealyBlocks(selectColumns(mealy.next, stateCount, inputCount, classes),
+            selectColumns(mealy.out, stateCount, inputCount, classes), stateCount, classes.size(), engine, pool);
+    return buildQuotient(mealy, blocks, canonicalizeBlocks(blocks));
+}
+
+MooreTable mooreMin(const MooreTable& moore, const string& engine, ThreadPool& pool)
+{
+    size_t stateCount = moore.stateCount();
+    size_t inputCount = moore.inputCount();
+    InputClasses classes = findInputClasses(stateCount, inputCount, moore.next, {});
+    recordAlphabetReduction(inputCount, classes.size());
+
+    vector<uint32_t> blocks = classes.size() == inputCount
+        ? mooreBlocks(moore.next, moore.out, stateCount, inputCount, engine, pool)
+        : mooreBlocks(selectColumns(moore.next, stateCount, inputCount, classes), moore.out,
+            stateCount, classes.size(), engine, pool);
+    return buildQuotient(moore, blocks, canonicalizeBlocks(blocks));
+}
+
+MealyTable mealyMin(const SparseMealy& mealy, const string& engine, ThreadPool& pool)
+{
+    vector<uint32_t> initialBlocks = sparseMealyInitialBlocks(mealy.offsets, mealy.symbols, mealy.next, mealy.out);
+    vector<uint32_t> blocks = refineSparse(mealy.offsets, mealy.symbols, mealy.next, initialBlocks, engine, pool);
+    return buildQuotient(mealy, blocks, canonicalizeBlocks(blocks));
+}
+
+MooreTable mooreMin(const SparseMoore& moore, const string& engine, ThreadPool& pool)
+{
+    vector<uint32_t> initialBlocks = sparseMooreInitialBlocks(moore.offsets, moore.symbols, moore.out);
+    vector<uint32_t> blocks = refineSparse(moore.offsets, moore.symbols, moore.next, initialBlocks, engine, pool);
+    return buildQuotient(moore, blocks, canonicalizeBlocks(blocks));
+}
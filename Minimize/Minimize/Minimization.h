@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Automaton.h"
+#include "SparseAutomaton.h"
+#include "ThreadPool.h"
+
+// Отсечение недостижимых состояний и минимизация выбранным движком разбиения.
+// Общие для Minimize и MinimizeBenchmark.
+
+const std::string ENGINE_ROUNDS = "rounds";
+const std::string ENGINE_HOPCROFT = "hopcroft";
+const std::string ENGINE_PARALLEL = "parallel";
+
+bool isKnownEngine(const std::string& engine);
+
+MealyTable findMealyReachableStates(const MealyTable& mealy, ThreadPool& pool);
+MooreTable findMooreReachableStates(const MooreTable& moore, ThreadPool& pool);
+SparseMealy findMealyReachableStates(const SparseMealy& mealy);
+SparseMoore findMooreReachableStates(const SparseMoore& moore);
+
+std::vector<uint32_t> refine(const std::vector<StateId>& next, size_t stateCount, size_t inputCount,
+    const std::vector<uint32_t>& initialBlocks, const std::string& engine, ThreadPool& pool);
+
+MealyTable mealyMin(const MealyTable& mealy, const std::string& engine, ThreadPool& pool);
+MooreTable mooreMin(const MooreTable& moore, const std::string& engine, ThreadPool& pool);
+
+// Минимизация разреженных таблиц без перехода к плотным; результат совпадает
+// с минимизацией той же таблицы в плотном виде. Поддерживаются движки rounds и parallel.
+MealyTable mealyMin(const SparseMealy& mealy, const std::string& engine, ThreadPool& pool);
+MooreTable mooreMin(const SparseMoore& moore, const std::string& engine, ThreadPool& pool);
@@ -1,650 +1,761 @@
 ﻿#include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
-#include <unordered_map>
-#include <iostream>
 #include <map>
-#include <set>
-#include <unordered_set>
 #include <algorithm>
-#include <queue>
+#include <stdexcept>
+
+#include "Automaton.h"
+#include "Batch.h"
+#include "BinaryFormat.h"
+#include "CodeGenerator.h"
+#include "CommandLine.h"
+#include "Composition.h"
+#include "Conversion.h"
+#include "CsvReader.h"
+#include "CsvWriter.h"
+#include "Diagnostics.h"
+#include "Equivalence.h"
+#include "Graph.h"
+#include "Incremental.h"
+#include "MappedFile.h"
+#include "OutputFile.h"
+#include "Minimization.h"
+#include "PartitionRefinement.h"
+#include "PhaseTimer.h"
+#include "ResultCache.h"
+#include "Runner.h"
+#include "Server.h"
+#include "SparseAutomaton.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
-vector<string> split(const string& s, char delimiter) 
+// Сводка по графу переходов (после отсечения недостижимых состояний) для --analyze.
+void PrintGraphReport(const vector<StateId>& next, size_t stateCount, size_t inputCount)
 {
-    vector<string> tokens;
-    string token;
-    istringstream tokenStream(s);
-    while (getline(tokenStream, token, delimiter)) 
+    StronglyConnectedComponents components = findStronglyConnectedComponents(next, stateCount, inputCount);
+    vector<char> sinks = findSinkStates(next, stateCount, inputCount);
+    vector<char> dead = findDeadStates(next, stateCount, inputCount);
+
+    cerr << "Reachable states: " << stateCount << "\n"
+        << "Strongly connected components: " << components.count << "\n"
+        << "Sink states: " << count(sinks.begin(), sinks.end(), 1) << "\n"
+        << "Dead states: " << count(dead.begin(), dead.end(), 1) << "\n";
+}
+
+// Минимизация с сохранением разбиения для следующего запуска. Если задана дельта
+// и сохранённое разбиение получено для этого же автомата, пересчитываются только
+// затронутые дельтой состояния; иначе автомат минимизируется целиком.
+template <typename Table>
+Table minimizeIncremental(Table& table, AutomatonKind kind, const string& partitionFileName, const string& deltaFileName,
+    ThreadPool& pool)
+{
+    SavedPartition saved;
+    vector<char> changed;
+    if (!deltaFileName.empty())
     {
-        if (token.empty())
+        if (!loadPartition(partitionFileName, kind, saved) || saved.fingerprint != fingerprint(table))
         {
-            token = "-";
+            cerr << "Saved partition does not match the input, minimizing from scratch.\n";
+            saved.blocks.clear();
         }
-        tokens.push_back(token);
+        changed = applyDelta(table, deltaFileName);
     }
-    return tokens;
-}
 
-struct Trans
-{
-    string inputSym;
-    string nextPos; 
-    string outSym; 
-};
+    vector<StateId> reachable = findReachable(table.next, table.stateCount(), table.inputCount(), pool);
+    vector<uint32_t> blocks = repartition(table, reachable, saved.blocks, changed);
+    uint32_t blockCount = blocks.empty() ? 0 : *max_element(blocks.begin(), blocks.end()) + 1;
 
-struct TransMoore
-{
-    string inputSym;
-    string nextPos; 
-};
+    SavedPartition updated;
+    updated.fingerprint = fingerprint(table);
+    updated.blocks.assign(table.stateCount(), NO_STATE);
+    for (size_t i = 0; i < reachable.size(); i++)
+    {
+        updated.blocks[reachable[i]] = blocks[i];
+    }
+    savePartition(partitionFileName, kind, updated);
 
-struct MealyState
-{
-    string curr;
-    vector<Trans> transitions;
-};
+    return buildQuotient(table, updated.blocks, blockCount);
+}
 
-struct MooreState
+void ReadMealy(MealyTable& mealy, const string& fileName, FileFormat format, ThreadPool& pool)
 {
-    string state;
-    string newState;
-    string output;
-    vector<TransMoore> transitions;
-};
+    if (format == FileFormat::Cpp)
+    {
+        throw runtime_error("Generated C++ source can not be read as an automaton: " + fileName);
+    }
+    if (format == FileFormat::Binary)
+    {
+        loadMealyBinary(fileName, mealy);
+    }
+    else
+    {
+        loadMealyCsv(fileName, mealy, pool);
+    }
+    recordFileRead(fileName);
+}
 
-vector<MealyState> findMealyReachableStates(const vector<MealyState>& mealyStates)
+void ReadMoore(MooreTable& moore, const string& fileName, FileFormat format, ThreadPool& pool, bool echo)
 {
-    if (mealyStates.empty()) return {};
-
-    unordered_set<string> visited;
-    queue<string> toVisit;
-    vector<MealyState> reachableStates;
-
-    visited.insert(mealyStates[0].curr);
-    toVisit.push(mealyStates[0].curr);
-    reachableStates.push_back(mealyStates[0]);
-
-    while (!toVisit.empty())
+    if (format == FileFormat::Cpp)
+    {
+        throw runtime_error("Generated C++ source can not be read as an automaton: " + fileName);
+    }
+    if (format == FileFormat::Binary)
+    {
+        loadMooreBinary(fileName, moore);
+    }
+    else
     {
-        string currentState = toVisit.front();
-        toVisit.pop();
+        loadMooreCsv(fileName, moore, pool);
+    }
+    recordFileRead(fileName);
 
-        for (const auto& state : mealyStates)
+    // Дамп переходов по входам для --verbose=trace.
+    for (size_t j = 0; echo && logEnabled(Verbosity::Trace) && j < moore.inputCount(); j++)
+    {
+        for (size_t i = 0; i < moore.stateCount(); i++)
         {
-            if (state.curr == currentState)
-            {
-                for (const auto& transition : state.transitions)
-                {
-                    if (visited.find(transition.nextPos) == visited.end())
-                    {
-                        visited.insert(transition.nextPos);
-                        toVisit.push(transition.nextPos);
-
-                        for (const auto& nextState : mealyStates)
-                        {
-                            if (nextState.curr == transition.nextPos)
-                            {
-                                reachableStates.push_back(nextState);
-                                break;
-                            }
-                        }
-                    }
-                }
-                break;
-            }
+            cerr << stateName(moore.states, moore.nextState(StateId(i), SymbolId(j))) << " ";
         }
+        cerr << " \n";
     }
-
-    return reachableStates;
 }
 
-vector<MooreState> findMooreReachableStates(const vector<MooreState>& mooreStates)
+// Чтение для --sparse: CSV разбирается сразу в строки CSR, бинарный формат
+// хранит плотную таблицу и переводится в CSR после чтения.
+void ReadMealy(SparseMealy& mealy, const string& fileName, FileFormat format, ThreadPool& pool)
 {
-    if (mooreStates.empty()) return {};
-
-    unordered_set<string> visited;
-    queue<string> toVisit;
-    vector<MooreState> reachableStates;
-
-    visited.insert(mooreStates[0].state);
-    toVisit.push(mooreStates[0].state);
-    reachableStates.push_back(mooreStates[0]);
-
-    while (!toVisit.empty())
+    if (format != FileFormat::Csv)
     {
-        string currentState = toVisit.front();
-        toVisit.pop();
-
-        for (const auto& state : mooreStates)
-        {
-            if (state.state == currentState)
-            {
-                for (const auto& transition : state.transitions)
-                {
-                    if (visited.find(transition.nextPos) == visited.end())
-                    {
-                        visited.insert(transition.nextPos);
-                        toVisit.push(transition.nextPos);
-
-                        for (const auto& nextState : mooreStates)
-                        {
-                            if (nextState.state == transition.nextPos)
-                            {
-                                reachableStates.push_back(nextState);
-                                break;
-                            }
-                        }
-                    }
-                }
-                break;
-            }
-        }
+        MealyTable dense;
+        ReadMealy(dense, fileName, format, pool);
+        mealy = toSparse(dense);
+        return;
     }
-
-    return reachableStates;
+    loadMealyCsv(fileName, mealy);
+    recordFileRead(fileName);
 }
 
-
-vector<MealyState> mealyMin(const vector<MealyState>& mealyAutomaton)
+void ReadMoore(SparseMoore& moore, const string& fileName, FileFormat format, ThreadPool& pool)
 {
-    map<string, string> newStateMap; 
-    set<vector<string>> vecOutSet;
-    map<vector<string>, string> vecOutNewStMap; 
-    vector<MealyState> newMealyAutomaton;
-    map <string, vector<string>> StateInGroup; 
-
-    char ch = 'A';
-    int stateCounter = 0;
-
-    for (const auto& state : mealyAutomaton)
+    if (format != FileFormat::Csv)
     {
-        vector<string> outVector;
-        for (const auto& transition : state.transitions)
-        {
-            outVector.push_back(transition.outSym);
-        }
-
-        if (vecOutSet.insert(outVector).second)
-        {
-            string newMinStateName = ch + to_string(stateCounter);
-            vecOutNewStMap[outVector] = newMinStateName;  
-            newStateMap[state.curr] = newMinStateName;
-            stateCounter++;
-        }
-        else
-        {
-            newStateMap[state.curr] = vecOutNewStMap[outVector];
-        }
-
+        MooreTable dense;
+        ReadMoore(dense, fileName, format, pool, false);
+        moore = toSparse(dense);
+        return;
     }
+    loadMooreCsv(fileName, moore);
+    recordFileRead(fileName);
+}
 
-    map <string, vector<MealyState>> NewMealyInGroup;
-
-    for (const auto& state : mealyAutomaton)
+bool WriteMealy(const MealyTable& mealy, OutputFile& outFile, ThreadPool& pool)
+{
+    if (outFile.is_open()) 
     {
-        MealyState tempState;
-        vector<Trans> tempVec;
-        for (const auto& transition : state.transitions)
+        writeMealyCsv(outFile.stream(), mealy, pool);
+        if (outFile.commit())
         {
-            Trans newTrans;
-            newTrans.inputSym = transition.inputSym;
-            newTrans.nextPos = newStateMap[transition.nextPos];
-
-            newTrans.outSym = transition.outSym;
-            tempVec.push_back(newTrans);
+            return true;
         }
-        tempState.curr = state.curr; 
-        tempState.transitions = tempVec;
-        NewMealyInGroup[newStateMap[tempState.curr]].push_back(tempState);
+        cerr << "Failed to write file.\n";
+        return false;
     }
+    cerr << "Failed to open file for writing.\n";
+    return false;
+}
 
-    auto prevSize = vecOutSet.size();
-    size_t currSize = 0;
-    bool equal = 0;
-    while (prevSize != currSize)
+bool WriteMoore(const MooreTable& moore, OutputFile& outFile, ThreadPool& pool)
+{
+    if (outFile.is_open())
     {
-        ch++;
-        int i = 0;
-        map<string, string> tempNewStateMap; 
-        map <string, vector<MealyState>> tempNewMealyInGroup; 
-
-        for (const auto& group : NewMealyInGroup)
+        writeMooreCsv(outFile.stream(), moore, pool);
+        if (outFile.commit())
         {
-            map<vector<string>, string> vecNextNewStMap; 
-            set<vector<string>> vecTransSet;
-            for (const auto& state : group.second)
-            {
-                vector<string> transVector;
-                for (const auto& transition : state.transitions)
-                {
-                    transVector.push_back(transition.nextPos);
-
-                }
-                if (vecTransSet.insert(transVector).second) 
-                {
-                    string newMinStateName = ch + to_string(i);
-                    vecNextNewStMap[transVector] = newMinStateName; 
-                    tempNewStateMap[state.curr] = newMinStateName;
-                    i++;
-                }
-                else
-                {
-                    tempNewStateMap[state.curr] = vecNextNewStMap[transVector];
-                }
-                currSize += vecTransSet.size();
-            }
+            return true;
         }
-        for (const auto& state : mealyAutomaton)
-        {
-            MealyState tempState;
-            vector<Trans> tempVec;
-            for (const auto& transition : state.transitions)
-            {
-                Trans newTrans;
-                newTrans.inputSym = transition.inputSym;
-                newTrans.nextPos = tempNewStateMap[transition.nextPos];
-                newTrans.outSym = transition.outSym;
-                tempVec.push_back(newTrans);
-            }
-            tempState.curr = state.curr;
-            tempState.transitions = tempVec;
-            tempNewMealyInGroup[tempNewStateMap[tempState.curr]].push_back(tempState);
-        }
-
-
-        NewMealyInGroup = tempNewMealyInGroup;
-        newStateMap = tempNewStateMap;
-
-        if (prevSize == currSize)
-        {
-            break;
-        }
-        else
-        {
-            prevSize = currSize;
-            currSize = 0;
-        }
-
-
+        cerr << "Failed to write file.\n";
+        return false;
     }
+    cerr << "Failed to open file for writing.\n";
+    return false;
+}
 
-    vector<MealyState> tempMealy;
-
-    for (const auto& group : NewMealyInGroup)
+bool SaveMealy(const MealyTable& mealy, const string& fileName, FileFormat format, const CodeGenOptions& codeOptions,
+    ThreadPool& pool)
+{
+    bool saved = true;
+    if (format == FileFormat::Binary)
     {
-        vector<Trans> tempVec;
-        MealyState tempState = group.second[0];
-
-        for (const auto& trans : tempState.transitions)
-        {
-            Trans newTrans;
-            newTrans.inputSym = trans.inputSym;
-            newTrans.nextPos = trans.nextPos;
-            newTrans.outSym = trans.outSym;
-            tempVec.push_back(newTrans);
-        }
-
-        tempState.curr = group.first;
-        tempState.transitions = tempVec;
-        NewMealyInGroup[newStateMap[tempState.curr]].push_back(tempState);
-        tempMealy.push_back(tempState);
+        saveMealyBinary(fileName, mealy);
+    }
+    else if (format == FileFormat::Cpp)
+    {
+        saveMealyCpp(fileName, mealy, codeOptions);
+    }
+    else
+    {
+        OutputFile outFile(fileName);
+        saved = WriteMealy(mealy, outFile, pool);
     }
+    recordFileWritten(fileName);
+    return saved;
+}
 
-    return tempMealy;
+bool SaveMoore(const MooreTable& moore, const string& fileName, FileFormat format, const CodeGenOptions& codeOptions,
+    ThreadPool& pool)
+{
+    bool saved = true;
+    if (format == FileFormat::Binary)
+    {
+        saveMooreBinary(fileName, moore);
+    }
+    else if (format == FileFormat::Cpp)
+    {
+        saveMooreCpp(fileName, moore, codeOptions);
+    }
+    else
+    {
+        OutputFile outFile(fileName);
+        saved = WriteMoore(moore, outFile, pool);
+    }
+    recordFileWritten(fileName);
+    return saved;
+}
 
+// Опции генерации кода для --out-format=cpp или вывода в .cpp/.h.
+CodeGenOptions CodeOptions(const CommandLine& commandLine, const string& outputFileName)
+{
+    CodeGenOptions codeOptions;
+    codeOptions.name = commandLine.option("code-name", codeNameFromFile(outputFileName));
+    codeOptions.style = parseCodeStyle(commandLine.option("code-style"));
+    string testVectors = commandLine.option("test-vectors", to_string(codeOptions.testVectors));
+    if (testVectors.empty() || testVectors.size() > 6
+        || !all_of(testVectors.begin(), testVectors.end(), [](char c) { return c >= '0' && c <= '9'; }))
+    {
+        throw runtime_error("Invalid --test-vectors value " + testVectors);
+    }
+    codeOptions.testVectors = stoul(testVectors);
+    return codeOptions;
 }
 
-vector<MooreState> mooreMin(const vector<MooreState>& mooreAutomaton)
+// Опции, от которых зависит выходной файл, для ключа кеша результатов.
+string CacheOptions(FileFormat inFormat, FileFormat outFormat, const CodeGenOptions& codeOptions)
 {
-    map<string, string> newStateMap;
-    set<string> outSet;
-    map<string, string> outNewStMap;
-    vector<MealyState> newMealyAutomaton;
-    map <string, vector<string>> StateInGroup; 
+    string options = "in=" + to_string(int(inFormat)) + ";out=" + to_string(int(outFormat));
+    if (outFormat == FileFormat::Cpp)
+    {
+        options += ";code=" + codeOptions.name + "," + to_string(int(codeOptions.style)) + ","
+            + to_string(codeOptions.testVectors);
+    }
+    return options;
+}
 
-    char ch = 'A';
-    int stateCounter = 0;
+// Минимизирует один файл с опциями командной строки. Возвращает false, если
+// результат не удалось записать; остальные ошибки сообщаются исключениями.
+bool MinimizeFile(const string& type, const string& inputFileName, const string& outputFileName,
+    const CommandLine& commandLine, ThreadPool& pool, bool echo)
+{
+    string engine = commandLine.option("engine", ENGINE_ROUNDS);
+    bool analyze = commandLine.has("analyze");
+    string deltaFileName = commandLine.option("delta");
+    bool incremental = commandLine.has("incremental") || !deltaFileName.empty();
+    bool sparse = commandLine.has("sparse");
+    string partitionFileName = commandLine.option("partition", outputFileName + PARTITION_EXTENSION);
+    string patchedFileName = commandLine.option("patched");
+
+    FileFormat inFormat = resolveFormat(inputFileName, commandLine.option("in-format"));
+    FileFormat outFormat = resolveFormat(outputFileName, commandLine.option("out-format"));
+    CodeGenOptions codeOptions = CodeOptions(commandLine, outputFileName);
+    if (sparse && incremental)
+    {
+        throw runtime_error("--sparse can not be combined with --incremental");
+    }
 
-    for (const auto& state : mooreAutomaton)
+    // С --incremental и --analyze результат — не только выходной файл, такие запуски не кешируются.
+    if (commandLine.has("cache") && !incremental && !analyze)
     {
-        vector<string> outVector;
+        CommandLine uncached = commandLine;
+        uncached.options.erase("cache");
+        return runCached(commandLine, "Minimize " + type, CacheOptions(inFormat, outFormat, codeOptions),
+            inputFileName, outputFileName, [&]
+            {
+                return MinimizeFile(type, inputFileName, outputFileName, uncached, pool, echo);
+            });
+    }
 
-        if (outSet.insert(state.output).second)
-        {
-            string newMinStateName = ch + to_string(stateCounter);
-            outNewStMap[state.output] = newMinStateName; 
-            newStateMap[state.state] = newMinStateName;
-            stateCounter++;
-        }
-        else
+    // Разреженные таблицы до записи результата не разворачиваются в states × inputs.
+    if (sparse && type == "mealy")
+    {
+        SparseMealy mealy;
+        ReadMealy(mealy, inputFileName, inFormat, pool);
+        markPhase("parse");
+        recordCounter("states", mealy.stateCount());
+        recordCounter("transitions", mealy.transitionCount());
+        SparseMealy reachableStates = findMealyReachableStates(mealy);
+        markPhase("reach");
+        recordCounter("reachable_states", reachableStates.stateCount());
+        if (analyze)
         {
-            newStateMap[state.state] = outNewStMap[state.output];
+            MealyTable dense = toDense(reachableStates);
+            PrintGraphReport(dense.next, dense.stateCount(), dense.inputCount());
+            markPhase("analyze");
         }
+        MealyTable minimize = mealyMin(reachableStates, engine, pool);
+        markPhase("refine");
+        recordCounter("result_states", minimize.stateCount());
+        bool saved = SaveMealy(minimize, outputFileName, outFormat, codeOptions, pool);
+        markPhase("write");
+        return saved;
     }
-
-
-    map <string, vector<MooreState>> NewMooreInGroup; 
-
-    for (const auto& state : mooreAutomaton)
+    if (sparse)
     {
-        MooreState tempState;
-        vector<TransMoore> tempVec;
-        for (const auto& transition : state.transitions)
+        SparseMoore moore;
+        ReadMoore(moore, inputFileName, inFormat, pool);
+        markPhase("parse");
+        recordCounter("states", moore.stateCount());
+        recordCounter("transitions", moore.transitionCount());
+        SparseMoore reachableStates = findMooreReachableStates(moore);
+        markPhase("reach");
+        recordCounter("reachable_states", reachableStates.stateCount());
+        if (analyze)
         {
-            TransMoore newTrans;
-            newTrans.inputSym = transition.inputSym;
-            newTrans.nextPos = newStateMap[transition.nextPos];
-            tempVec.push_back(newTrans);
+            MooreTable dense = toDense(reachableStates);
+            PrintGraphReport(dense.next, dense.stateCount(), dense.inputCount());
+            markPhase("analyze");
         }
-        tempState.output = state.output;
-        tempState.state = state.state;
-        tempState.transitions = tempVec;
-        NewMooreInGroup[newStateMap[tempState.state]].push_back(tempState);
-
+        MooreTable minimize = mooreMin(reachableStates, engine, pool);
+        markPhase("refine");
+        recordCounter("result_states", minimize.stateCount());
+        bool saved = SaveMoore(minimize, outputFileName, outFormat, codeOptions, pool);
+        markPhase("write");
+        return saved;
     }
 
-    auto prevSize = outSet.size();
-    size_t currSize = 0;
-    bool equal = 0;
-    while (prevSize != currSize)
+    if (type == "mealy")
     {
-        ch++;
-        int i = 0;
-        currSize = 0;
-        map<string, string> tempNewStateMap; 
-        map <string, vector<MooreState>> tempNewMooreInGroup; 
-
-        for (const auto& group : NewMooreInGroup)
+        MealyTable mealy;
+        ReadMealy(mealy, inputFileName, inFormat, pool);
+        markPhase("parse");
+        recordCounter("states", mealy.stateCount());
+        if (incremental)
         {
-            map<vector<string>, string> vecNextNewStMap; 
-            set<vector<string>> vecTransSet;
-            for (const auto& state : group.second)
+            MealyTable minimize = minimizeIncremental(mealy, AutomatonKind::Mealy, partitionFileName, deltaFileName, pool);
+            markPhase("repartition");
+            recordCounter("result_states", minimize.stateCount());
+            bool saved = SaveMealy(minimize, outputFileName, outFormat, codeOptions, pool);
+            if (!patchedFileName.empty())
             {
-                vector<string> transVector;
-                for (const auto& transition : state.transitions)
-                {
-                    transVector.push_back(transition.nextPos);
-                }
-                if (vecTransSet.insert(transVector).second) 
-                {
-                    string newMinStateName = ch + to_string(i);
-                    vecNextNewStMap[transVector] = newMinStateName;
-                    tempNewStateMap[state.state] = newMinStateName;
-                    i++;
-                }
-                else
-                {
-                    tempNewStateMap[state.state] = vecNextNewStMap[transVector];
-                }
-                currSize += vecTransSet.size();
+                SaveMealy(mealy, patchedFileName, resolveFormat(patchedFileName, ""), codeOptions, pool);
             }
+            markPhase("write");
+            return saved;
         }
-        for (const auto& state : mooreAutomaton)
+        MealyTable reachableStates = findMealyReachableStates(mealy, pool);
+        markPhase("reach");
+        recordCounter("reachable_states", reachableStates.stateCount());
+        if (analyze)
         {
-            MooreState tempState;
-            vector<TransMoore> tempVec;
-            for (const auto& transition : state.transitions)
-            {
-                TransMoore newTrans;
-                newTrans.inputSym = transition.inputSym;
-                newTrans.nextPos = tempNewStateMap[transition.nextPos];
-                tempVec.push_back(newTrans);
-            }
-            tempState.state = state.state; 
-            tempState.output = state.output;
-            tempState.transitions = tempVec;
-            tempNewMooreInGroup[tempNewStateMap[tempState.state]].push_back(tempState);
+            PrintGraphReport(reachableStates.next, reachableStates.stateCount(), reachableStates.inputCount());
+            markPhase("analyze");
         }
-
-        NewMooreInGroup = tempNewMooreInGroup;
-        newStateMap = tempNewStateMap;
-
-        if (prevSize == currSize)
-        {
-            break;
-        }
-        else
-        {
-            prevSize = currSize;
-            currSize = 0;
-        }
-
+        MealyTable minimize = mealyMin(reachableStates, engine, pool);
+        markPhase("refine");
+        recordCounter("result_states", minimize.stateCount());
+        bool saved = SaveMealy(minimize, outputFileName, outFormat, codeOptions, pool);
+        markPhase("write");
+        return saved;
     }
 
-    vector<MooreState> tempMealy;
-
-    for (const auto& group : NewMooreInGroup)
+    MooreTable moore;
+    ReadMoore(moore, inputFileName, inFormat, pool, echo);
+    markPhase("parse");
+    recordCounter("states", moore.stateCount());
+    if (incremental)
     {
-        vector<TransMoore> tempVec;
-        MooreState tempState = group.second[0];
-
-        for (const auto& trans : tempState.transitions)
+        MooreTable minimize = minimizeIncremental(moore, AutomatonKind::Moore, partitionFileName, deltaFileName, pool);
+        markPhase("repartition");
+        recordCounter("result_states", minimize.stateCount());
+        bool saved = SaveMoore(minimize, outputFileName, outFormat, codeOptions, pool);
+        if (!patchedFileName.empty())
         {
-            TransMoore newTrans;
-            newTrans.inputSym = trans.inputSym;
-            newTrans.nextPos = trans.nextPos;
-            tempVec.push_back(newTrans);
+            SaveMoore(moore, patchedFileName, resolveFormat(patchedFileName, ""), codeOptions, pool);
         }
-        tempState.state = group.first;
-        tempState.output = group.second[0].output;
-        tempState.transitions = tempVec;
-        NewMooreInGroup[newStateMap[tempState.state]].push_back(tempState);
-        tempMealy.push_back(tempState);
+        markPhase("write");
+        return saved;
     }
-
-    return tempMealy;
+    MooreTable reachableStates = findMooreReachableStates(moore, pool);
+    markPhase("reach");
+    recordCounter("reachable_states", reachableStates.stateCount());
+    if (analyze)
+    {
+        PrintGraphReport(reachableStates.next, reachableStates.stateCount(), reachableStates.inputCount());
+        markPhase("analyze");
+    }
+    MooreTable minimize = mooreMin(reachableStates, engine, pool);
+    markPhase("refine");
+    recordCounter("result_states", minimize.stateCount());
+    bool saved = SaveMoore(minimize, outputFileName, outFormat, codeOptions, pool);
+    markPhase("write");
+    return saved;
 }
 
-vector<MealyState> ReadMealy(vector<MealyState>& positions, ifstream& file)
+// Режим convert <mealy-to-moore|moore-to-mealy> <in> <out>: отсечение недостижимых
+// состояний, преобразование и минимизация результата идут в памяти, записывается
+// только минимальный автомат. С --timings печатается время каждого этапа.
+bool ConvertAndMinimize(const CommandLine& commandLine, ThreadPool& pool)
 {
-
-    string line;
-    getline(file, line);
-    vector<string> tempRow = split(line, ';');
-
-
-    for (size_t i = 1; i < tempRow.size(); ++i) 
+    const string& conversion = commandLine.args[1];
+    const string& inputFileName = commandLine.args[2];
+    const string& outputFileName = commandLine.args[3];
+    if (conversion != "mealy-to-moore" && conversion != "moore-to-mealy")
     {
-        MealyState currPos;
-        currPos.curr = tempRow[i];
-        positions.push_back(currPos);
+        throw runtime_error("Unknown conversion type " + conversion);
     }
+    string engine = commandLine.option("engine", ENGINE_ROUNDS);
+    FileFormat inFormat = resolveFormat(inputFileName, commandLine.option("in-format"));
+    FileFormat outFormat = resolveFormat(outputFileName, commandLine.option("out-format"));
+    CodeGenOptions codeOptions = CodeOptions(commandLine, outputFileName);
 
-    vector<string> tRow;
-    while (getline(file, line))
+    PhaseTimer timer;
+    auto mark = [&](const string& phase)
     {
-        tempRow = split(line, ';');
-        string input_sym = tempRow[0];
-        for (int i = 0; i < positions.size(); i++)
+        timer.mark(phase);
+        markPhase(phase);
+    };
+    bool saved;
+    if (conversion == "mealy-to-moore")
+    {
+        MealyTable mealy;
+        ReadMealy(mealy, inputFileName, inFormat, pool);
+        mark("read");
+        if (mealy.stateCount() == 0)
         {
-            if (i + 1 >= tempRow.size()) {
-                cerr << "Error: Not enough columns in input file." << endl;
-                continue;
-            }
-
-            Trans trans;
-            tRow = split(tempRow[i + 1], '/');
-            
-            if (tRow.size() < 2) {
-                cerr << "Error: Invalid transition format." << endl;
-                continue;
-            }
-
-            trans.inputSym = input_sym;
-            trans.nextPos = tRow[0];
-            trans.outSym = tRow[1];
-            positions[i].transitions.push_back(trans);
+            throw runtime_error("Empty automaton.");
         }
-    };
-    file.close();
+        MealyTable reachableStates = findMealyReachableStates(mealy, pool);
+        mark("reachability");
+        // Состояния результата строятся обходом от начального и уже все достижимы.
+        MooreTable moore = mealyToMoore(reachableStates, pool);
+        mark("conversion");
+        MooreTable minimize = mooreMin(moore, engine, pool);
+        mark("minimization");
+        saved = SaveMoore(minimize, outputFileName, outFormat, codeOptions, pool);
+    }
+    else
+    {
+        MooreTable moore;
+        ReadMoore(moore, inputFileName, inFormat, pool, false);
+        mark("read");
+        MooreTable reachableStates = findMooreReachableStates(moore, pool);
+        mark("reachability");
+        MealyTable mealy = mooreToMealy(reachableStates);
+        mark("conversion");
+        MealyTable minimize = mealyMin(mealy, engine, pool);
+        mark("minimization");
+        saved = SaveMealy(minimize, outputFileName, outFormat, codeOptions, pool);
+    }
+    mark("write");
 
-    return positions;
+    if (commandLine.has("timings"))
+    {
+        timer.report(cout);
+    }
+    return saved;
 }
 
-vector<MooreState> ReadMoore(vector<MooreState>& positions, ifstream& file)
+// Пакетный режим: batch <manifest> или batch <mealy|moore> <in-dir> <out-dir>.
+int RunBatch(const CommandLine& commandLine, ThreadPool& pool)
 {
-    string line, lineSt;
-    getline(file, line);
-    vector<string> tempRow = split(line, ';');
-    getline(file, lineSt);
-    vector<string> tempRowSt = split(lineSt, ';');
+    vector<BatchJob> jobs = commandLine.args.size() == 2
+        ? readManifest(commandLine.args[1])
+        : listDirectoryJobs(commandLine.args[1], commandLine.args[2], commandLine.args[3]);
 
-    for (size_t i = 1; i < tempRow.size(); ++i) 
+    size_t failed = runBatch(jobs, [&](const BatchJob& job)
     {
-        MooreState state;
-        if (i >= tempRow.size())
+        if (job.mode != "mealy" && job.mode != "moore")
         {
-            state.output = "-";
+            throw runtime_error("Unknown automaton type " + job.mode);
         }
-        else
+        if (!MinimizeFile(job.mode, job.input, job.output, commandLine, pool, false))
         {
-            state.output = tempRow[i];
+            throw runtime_error("Failed to open file for writing.");
         }
+    }, cout, pool);
+    return failed == 0 ? 0 : 1;
+}
 
-        state.state = tempRowSt[i]; 
-        positions.push_back(state);
+// Режим run <mealy|moore> <machine> <inputs> <outputs>: прогоняет через автомат
+// последовательности входных символов, по одной в строке. С --kernel файл прогоняется
+// пакетом выбранным ядром и печатается пропускная способность.
+int RunMachine(const CommandLine& commandLine, ThreadPool& pool)
+{
+    const string& type = commandLine.args[1];
+    const string& machineFileName = commandLine.args[2];
+    FileFormat format = resolveFormat(machineFileName, commandLine.option("in-format"));
+    if (type != "mealy" && type != "moore")
+    {
+        throw runtime_error("Unknown automaton type " + type);
     }
 
-    string tRow;
-
-    while (getline(file, line))
+    auto load = [&]()
     {
-        tempRow = split(line, ';');
-        string input_sym = tempRow[0];
-        for (int i = 0; i < positions.size(); i++)
+        if (type == "mealy")
         {
-            TransMoore trans;
-            trans.inputSym = input_sym;
-            if ((i + 1) >= tempRow.size())
-            {
-                trans.nextPos = "-";
-            }
-            else
-            {
-                trans.nextPos = tempRow[i + 1];
-            }
-            std::cout << trans.nextPos << " ";
-            positions[i].transitions.push_back(trans);
+            MealyTable mealy;
+            ReadMealy(mealy, machineFileName, format, pool);
+            return AutomatonRunner(mealy);
         }
-        cout << " \n";
+        MooreTable moore;
+        ReadMoore(moore, machineFileName, format, pool, false);
+        return AutomatonRunner(moore);
     };
-    file.close();
+    AutomatonRunner runner = load();
+    markPhase("parse");
 
-    return positions;
-}
-
-
-void WriteMealy(vector<MealyState>& mealyAutomaton, ofstream& outFile) 
-{
-    if (outFile.is_open()) 
+    MappedFile input(commandLine.args[3]);
+    ofstream output(commandLine.args[4], ios::binary);
+    if (!output.is_open())
     {
-        for (const auto& state : mealyAutomaton) 
-        {
-            outFile << ";" << state.curr;
-        }
-        outFile << "\n";
-
-        for (size_t i = 0; i < mealyAutomaton[0].transitions.size(); ++i) 
+        throw runtime_error("Failed to open file for writing.");
+    }
+    string_view text(input.data(), input.size());
+    RunSummary summary;
+    if (commandLine.has("kernel"))
+    {
+        string kernelName = commandLine.option("kernel");
+        RunKernel kernel = bestRunKernel();
+        if (kernelName != "auto")
         {
-            const auto& inputSym = mealyAutomaton[0].transitions[i].inputSym;
-            outFile << inputSym;
-
-            for (const auto& state : mealyAutomaton) 
+            vector<RunKernel> kernels = { RunKernel::Sequential, RunKernel::Scalar, RunKernel::Avx2, RunKernel::Avx512 };
+            auto found = find_if(kernels.begin(), kernels.end(), [&](RunKernel k) { return kernelName == runKernelName(k); });
+            if (found == kernels.end())
             {
-                const auto& trans = state.transitions[i];
-                outFile << ";" << trans.nextPos << "/" << trans.outSym;
+                throw runtime_error("Unknown run kernel " + kernelName);
             }
-            outFile << "\n";
+            kernel = *found;
         }
-        outFile.close();
+        summary = runTextBatch(runner, text, output, cerr, cout, pool, kernel);
+    }
+    else
+    {
+        summary = runTextStream(runner, text, output, cerr, pool);
     }
-    else 
+    if (!output)
     {
-        cerr << "Failed to open file for writing.\n";
+        throw runtime_error("Failed to write " + commandLine.args[4]);
     }
+    output.close();
+    markPhase("run");
+    recordFileRead(commandLine.args[3]);
+    recordFileWritten(commandLine.args[4]);
+    recordCounter("traces", summary.lines);
+    recordCounter("steps", summary.steps);
+    return summary.failedLines == 0 ? 0 : 1;
 }
 
-void WriteMoore(vector<MooreState>& mooreAutomaton, ofstream& outFile)
+// Режим compose <product|cascade> <out> <first> <second> [...]: автоматы Мили
+// объединяются слева направо. С --minimize каждый промежуточный результат сразу
+// минимизируется, и следующая композиция строится по меньшему автомату.
+bool ComposeMachines(const CommandLine& commandLine, ThreadPool& pool)
 {
-    if (outFile.is_open())
+    const string& operation = commandLine.args[1];
+    const string& outputFileName = commandLine.args[2];
+    if (operation != "product" && operation != "cascade")
     {
+        throw runtime_error("Unknown composition " + operation);
+    }
+    string engine = commandLine.option("engine", ENGINE_ROUNDS);
+    string formatOption = commandLine.option("in-format");
+    FileFormat outFormat = resolveFormat(outputFileName, commandLine.option("out-format"));
+    CodeGenOptions codeOptions = CodeOptions(commandLine, outputFileName);
 
-        for (const auto& state : mooreAutomaton)
-        {
-            outFile << ";" << state.output;
-        }
-        outFile << "\n";
-
-        for (const auto& state : mooreAutomaton)
+    auto read = [&](const string& fileName)
+    {
+        MealyTable mealy;
+        ReadMealy(mealy, fileName, resolveFormat(fileName, formatOption), pool);
+        return mealy;
+    };
+    MealyTable result = read(commandLine.args[3]);
+    for (size_t i = 4; i < commandLine.args.size(); i++)
+    {
+        MealyTable next = read(commandLine.args[i]);
+        markPhase("parse");
+        result = operation == "product" ? productMealy(result, next) : cascadeMealy(result, next);
+        markPhase("compose");
+        recordCounter("composed_states", result.stateCount());
+        if (commandLine.has("minimize"))
         {
-            outFile << ";" << state.state;
+            result = mealyMin(result, engine, pool);
+            markPhase("refine");
         }
-        outFile << "\n";
-
-        for (size_t i = 0; i < mooreAutomaton[0].transitions.size(); ++i) 
-        {
-            const auto& inputSym = mooreAutomaton[0].transitions[i].inputSym;
-            outFile << inputSym;
+    }
+    recordCounter("result_states", result.stateCount());
+    bool saved = SaveMealy(result, outputFileName, outFormat, codeOptions, pool);
+    markPhase("write");
+    return saved;
+}
 
-            for (const auto& state : mooreAutomaton) 
-            {
-                const auto& trans = state.transitions[i];
-                outFile << ";" << trans.nextPos;
-            }
-            outFile << "\n";
-        }
+// Режим equiv <mealy|moore> <first> <second>: проверка эквивалентности автоматов.
+// Возвращает 0 для эквивалентных и 1 с различающим словом для различных.
+int CheckEquivalence(const CommandLine& commandLine, ThreadPool& pool)
+{
+    const string& type = commandLine.args[1];
+    const string& firstFileName = commandLine.args[2];
+    const string& secondFileName = commandLine.args[3];
+    if (type != "mealy" && type != "moore")
+    {
+        throw runtime_error("Unknown automaton type " + type);
+    }
+    string formatOption = commandLine.option("in-format");
 
-        outFile.close();
+    EquivalenceResult result;
+    if (type == "mealy")
+    {
+        MealyTable first;
+        MealyTable second;
+        ReadMealy(first, firstFileName, resolveFormat(firstFileName, formatOption), pool);
+        ReadMealy(second, secondFileName, resolveFormat(secondFileName, formatOption), pool);
+        markPhase("parse");
+        result = checkEquivalence(first, second);
     }
     else
     {
-        cerr << "Failed to open file for writing.\n";
+        MooreTable first;
+        MooreTable second;
+        ReadMoore(first, firstFileName, resolveFormat(firstFileName, formatOption), pool, false);
+        ReadMoore(second, secondFileName, resolveFormat(secondFileName, formatOption), pool, false);
+        markPhase("parse");
+        result = checkEquivalence(first, second);
     }
+    markPhase("compare");
 
+    if (result.equivalent)
+    {
+        cout << "Equivalent" << endl;
+        return 0;
+    }
+    cout << "Not equivalent\nDistinguishing input:";
+    if (result.word.empty())
+    {
+        cout << " (empty)";
+    }
+    for (const auto& input : result.word)
+    {
+        cout << " " << input;
+    }
+    cout << "\nOutputs: " << result.firstOutput << " vs " << result.secondOutput << "\n";
+    if (!result.shortest)
+    {
+        cout << "The word may not be the shortest one.\n";
+    }
+    cout.flush();
+    return 1;
 }
 
-
 int main(int argc, char* argv[])
 {
-    if (argc != 4)
+    CommandLine commandLine = parseCommandLine(argc, argv);
+    string engine = commandLine.option("engine", ENGINE_ROUNDS);
+    string threadsOption = commandLine.option("threads", "0");
+    bool threadsValid = !threadsOption.empty() && threadsOption.size() < 5
+        && all_of(threadsOption.begin(), threadsOption.end(), [](char c) { return c >= '0' && c <= '9'; });
+    bool batch = !commandLine.args.empty() && commandLine.args[0] == "batch";
+    bool run = !commandLine.args.empty() && commandLine.args[0] == "run";
+    bool convert = !commandLine.args.empty() && commandLine.args[0] == "convert";
+    bool equiv = !commandLine.args.empty() && commandLine.args[0] == "equiv";
+    bool compose = !commandLine.args.empty() && commandLine.args[0] == "compose";
+    bool serve = !commandLine.args.empty() && commandLine.args[0] == "serve";
+    size_t argCount = commandLine.args.size();
+
+    if ((batch ? argCount != 2 && argCount != 4 : run ? argCount != 5 : convert || equiv ? argCount != 4
+            : compose ? argCount < 5 : serve ? argCount != 2 : argCount != 3)
+        || !threadsValid
+        || !isKnownEngine(engine))
     {
-        cout << "Usage: " << argv[0] << " <mealy|moore> <in.csv> <out.csv>" << endl;
+        cout << "Usage: " << argv[0] << " <mealy|moore> <in.csv> <out.csv> [--engine=rounds|hopcroft|parallel]"
+            << " [--threads=N] [--in-format=csv|bin] [--out-format=csv|bin|cpp] [--analyze]"
+            << " [--code-name=<namespace>] [--code-style=auto|table|switch|constexpr] [--test-vectors=N]"
+            << " [--incremental] [--partition=<file>] [--delta=<file>] [--patched=<file>] [--sparse]\n"
+            << "       " << argv[0] << " batch <manifest> | batch <mealy|moore> <in-dir> <out-dir> [options]\n"
+            << "       " << argv[0] << " convert <mealy-to-moore|moore-to-mealy> <in> <out> [options] [--timings]\n"
+            << "       " << argv[0] << " run <mealy|moore> <machine> <inputs.txt> <outputs.txt> [--in-format=csv|bin]"
+            << " [--kernel=auto|sequential|scalar|avx2|avx512] [--threads=N]\n"
+            << "       " << argv[0] << " equiv <mealy|moore> <first> <second> [--in-format=csv|bin]\n"
+            << "       " << argv[0] << " compose <product|cascade> <out> <mealy1> <mealy2> [<mealy3> ...]"
+            << " [--minimize] [options]\n"
+            << "       " << argv[0] << " serve <socket> [--engine=...] [--threads=N]\n"
+            << "Diagnostics for every mode: [--quiet] [--verbose[=info|debug|trace]] [--stats[=<file.json>]]\n"
+            << "Result cache for minimization: [--cache=<dir>] [--cache-size=<N[K|M|G]>] [--cache-link]\n"
+            << "Manifest lines: <mealy|moore>;<in>;<out>\n"
+            << "Run input: one sequence of input symbols per line, separated by spaces, ';' or ','" << endl;
         return 1;
     }
 
-    string type = argv[1];
-    string inputFileName = argv[2];
-    string outputFileName = argv[3];
+    // Без --threads используется общий пул на все ядра.
+    size_t threads = stoul(threadsOption);
+    ThreadPool ownPool(threads == 0 ? 0 : threads - 1);
+    ThreadPool& pool = threads == 0 ? ThreadPool::instance() : ownPool;
 
-    ifstream file(inputFileName);
-    ofstream outFile(outputFileName);
-
-    if (!file.is_open())
+    RunStats stats;
+    bool collectStats = commandLine.has("stats");
+    int status = 0;
+    try
     {
-        cerr << "Ошибка при открытии файла!" << endl;
-        return 1;
-    }
+        setVerbosity(verbosityOption(commandLine));
+        // В пакетном режиме файлы обрабатываются параллельно, и в отчёт попадает только общее время.
+        if (collectStats && !batch)
+        {
+            RunStats::setActive(&stats);
+        }
+        recordCounter("threads", pool.concurrency());
 
-    if (type == "mealy")
-    {
-        vector<MealyState> mealyStates;
-        mealyStates = ReadMealy(mealyStates, file);
-        vector<MealyState> reachableStates = findMealyReachableStates(mealyStates);
-        vector<MealyState> minimize = mealyMin(reachableStates);
-        WriteMealy(minimize, outFile);
+        if (batch)
+        {
+            status = RunBatch(commandLine, pool);
+            stats.mark("batch");
+        }
+        else if (run)
+        {
+            status = RunMachine(commandLine, pool);
+        }
+        else if (convert)
+        {
+            status = ConvertAndMinimize(commandLine, pool) ? 0 : 1;
+        }
+        else if (equiv)
+        {
+            status = CheckEquivalence(commandLine, pool);
+        }
+        else if (compose)
+        {
+            status = ComposeMachines(commandLine, pool) ? 0 : 1;
+        }
+        else if (serve)
+        {
+            // Запросы обслуживает столько потоков, сколько участвует в пуле.
+            MachineServer server(pool, engine);
+            serveUnixSocket(commandLine.args[1], server, pool.concurrency());
+        }
+        else
+        {
+            status = MinimizeFile(commandLine.args[0], commandLine.args[1], commandLine.args[2], commandLine, pool, true)
+                ? 0 : 1;
+        }
+
+        if (collectStats)
+        {
+            stats.save(commandLine.option("stats"));
+        }
     }
-    else
+    catch (const exception& e)
     {
-        vector<MooreState> mooreStates;
-        mooreStates = ReadMoore(mooreStates, file);
-        vector<MooreState> reachableStates = findMooreReachableStates(mooreStates);
-        vector<MooreState> minimize = mooreMin(reachableStates);
-        WriteMoore(minimize, outFile);
+        cerr << "Ошибка: " << e.what() << endl;
+        return 1;
     }
 
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
@@ -0,0 +1,611 @@
+﻿#include "PartitionRefinement.h"
+
+#include <algorithm>
+
+#include "Diagnostics.h"
+#include "Hashing.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+namespace
+{
+    // Состояний на один отрезок параллельного раунда.
+    constexpr size_t ROUND_GRAIN = size_t(1) << 15;
+
+    // Таблица сигнатур с открытой адресацией. Класс представлен первым встреченным
+    // состоянием; сигнатуры сравниваются по текущему разбиению, без копирования.
+    // Память сохраняется между reset, поэтому раунды не выделяют её заново.
+    class SignatureTable
+    {
+    public:
+        void reset(size_t expected)
+        {
+            size_t capacity = 16;
+            while (capacity < expected * 2)
+            {
+                capacity *= 2;
+            }
+            m_slots.assign(capacity, NO_STATE);
+            m_representatives.clear();
+            m_hashes.clear();
+            m_representatives.reserve(expected);
+            m_hashes.reserve(expected);
+        }
+
+        // Возвращает номер класса сигнатуры состояния p, добавляя класс при необходимости.
+        template <typename Equal>
+        uint32_t insert(uint32_t p, uint64_t hash, const Equal& equal)
+        {
+            if ((m_representatives.size() + 1) * 2 > m_slots.size())
+            {
+                grow();
+            }
+            size_t mask = m_slots.size() - 1;
+            for (size_t slot = size_t(hash) & mask;; slot = (slot + 1) & mask)
+            {
+                uint32_t id = m_slots[slot];
+                if (id == NO_STATE)
+                {
+                    id = uint32_t(m_representatives.size());
+                    m_slots[slot] = id;
+                    m_representatives.push_back(p);
+                    m_hashes.push_back(hash);
+                    return id;
+                }
+                if (m_hashes[id] == hash && equal(m_representatives[id], p))
+                {
+                    return id;
+                }
+            }
+        }
+
+        size_t size() const { return m_representatives.size(); }
+        uint32_t representative(uint32_t id) const { return m_representatives[id]; }
+        uint64_t hash(uint32_t id) const { return m_hashes[id]; }
+
+    private:
+        void grow()
+        {
+            m_slots.assign(max<size_t>(16, m_slots.size() * 2), NO_STATE);
+            size_t mask = m_slots.size() - 1;
+            for (uint32_t id = 0; id < m_representatives.size(); id++)
+            {
+                size_t slot = size_t(m_hashes[id]) & mask;
+                while (m_slots[slot] != NO_STATE)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                m_slots[slot] = id;
+            }
+        }
+
+        vector<uint32_t> m_slots;
+        vector<uint32_t> m_representatives;
+        vector<uint64_t> m_hashes;
+    };
+
+    // Сигнатура состояния p: его блок и блоки преемников (NO_STATE для неопределённых переходов).
+    struct DenseSignature
+    {
+        const vector<uint32_t>& next;
+        size_t inputCount;
+
+        uint64_t hash(const vector<uint32_t>& blocks, size_t p) const
+        {
+            uint64_t hash = mixHash(0, blocks[p]);
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t t = next[p * inputCount + a];
+                hash = mixHash(hash, t == NO_STATE ? NO_STATE : blocks[t]);
+            }
+            return hash;
+        }
+
+        bool same(const vector<uint32_t>& blocks, uint32_t p, uint32_t q) const
+        {
+            if (blocks[p] != blocks[q])
+            {
+                return false;
+            }
+            for (size_t a = 0; a < inputCount; a++)
+            {
+                uint32_t tp = next[p * inputCount + a];
+                uint32_t tq = next[q * inputCount + a];
+                if ((tp == NO_STATE ? NO_STATE : blocks[tp]) != (tq == NO_STATE ? NO_STATE : blocks[tq]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // Та же сигнатура по строкам CSR: блок и пары (вход, блок преемника) хранимых переходов.
+    // Пропущенные ячейки в сигнатуру не входят, но у состояний одного начального блока
+    // набор хранимых входов одинаков, поэтому разбиение совпадает с плотным.
+    struct SparseSignature
+    {
+        const vector<size_t>& offsets;
+        const vector<uint32_t>& symbols;
+        const vector<uint32_t>& next;
+
+        uint64_t hash(const vector<uint32_t>& blocks, size_t p) const
+        {
+            uint64_t hash = mixHash(0, blocks[p]);
+            for (size_t i = offsets[p]; i < offsets[p + 1]; i++)
+            {
+                uint32_t t = next[i];
+                hash = mixHash(mixHash(hash, symbols[i]), t == NO_STATE ? NO_STATE : blocks[t]);
+            }
+            return hash;
+        }
+
+        bool same(const vector<uint32_t>& blocks, uint32_t p, uint32_t q) const
+        {
+            if (blocks[p] != blocks[q] || offsets[p + 1] - offsets[p] != offsets[q + 1] - offsets[q])
+            {
+                return false;
+            }
+            for (size_t i = offsets[p], j = offsets[q]; i < offsets[p + 1]; i++, j++)
+            {
+                uint32_t tp = next[i];
+                uint32_t tq = next[j];
+                if (symbols[i] != symbols[j]
+                    || (tp == NO_STATE ? NO_STATE : blocks[tp]) != (tq == NO_STATE ? NO_STATE : blocks[tq]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // Номер класса каждого состояния по строке, которую задают hashRow и sameRow;
+    // классы пронумерованы в порядке первого вхождения.
+    template <typename HashRow, typename SameRow>
+    vector<uint32_t> classifyRows(size_t stateCount, const HashRow& hashRow, const SameRow& sameRow)
+    {
+        vector<uint32_t> classes(stateCount);
+        SignatureTable table;
+        table.reset(min<size_t>(stateCount, 1024));
+        for (size_t p = 0; p < stateCount; p++)
+        {
+            classes[p] = table.insert(uint32_t(p), hashRow(p), sameRow);
+        }
+        return classes;
+    }
+}
+
+uint32_t canonicalizeBlocks(vector<uint32_t>& blocks)
+{
+    uint32_t maxBlock = 0;
+    for (auto block : blocks)
+    {
+        maxBlock = max(maxBlock, block);
+    }
+
+    vector<uint32_t> remap(blocks.empty() ? 0 : size_t(maxBlock) + 1, NO_STATE);
+    uint32_t count = 0;
+    for (auto& block : blocks)
+    {
+        if (remap[block] == NO_STATE)
+        {
+            remap[block] = count++;
+        }
+        block = remap[block];
+    }
+    return count;
+}
+
+vector<uint32_t> mealyInitialBlocks(size_t stateCount, size_t inputCount,
+    const vector<uint32_t>& next, const vector<uint32_t>& out)
+{
+    auto hashRow = [&](size_t p)
+    {
+        uint64_t hash = 0;
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            hash = mixHash(hash, out[p * inputCount + a]);
+            hash = mixHash(hash, next[p * inputCount + a] == NO_STATE);
+        }
+        return hash;
+    };
+    auto sameRow = [&](uint32_t p, uint32_t q)
+    {
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            if (out[p * inputCount + a] != out[q * inputCount + a]
+                || (next[p * inputCount + a] == NO_STATE) != (next[q * inputCount + a] == NO_STATE))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    return classifyRows(stateCount, hashRow, sameRow);
+}
+
+vector<uint32_t> mooreInitialBlocks(size_t stateCount, size_t inputCount,
+    const vector<uint32_t>& next, const vector<uint32_t>& out)
+{
+    auto hashRow = [&](size_t p)
+    {
+        uint64_t hash = mixHash(0, out[p]);
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            hash = mixHash(hash, next[p * inputCount + a] == NO_STATE);
+        }
+        return hash;
+    };
+    auto sameRow = [&](uint32_t p, uint32_t q)
+    {
+        if (out[p] != out[q])
+        {
+            return false;
+        }
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            if ((next[p * inputCount + a] == NO_STATE) != (next[q * inputCount + a] == NO_STATE))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    return classifyRows(stateCount, hashRow, sameRow);
+}
+
+vector<uint32_t> sparseMealyInitialBlocks(const vector<size_t>& offsets, const vector<uint32_t>& symbols,
+    const vector<uint32_t>& next, const vector<uint32_t>& out)
+{
+    auto hashRow = [&](size_t p)
+    {
+        uint64_t hash = 0;
+        for (size_t i = offsets[p]; i < offsets[p + 1]; i++)
+        {
+            hash = mixHash(hash, symbols[i]);
+            hash = mixHash(hash, out[i]);
+            hash = mixHash(hash, next[i] == NO_STATE);
+        }
+        return hash;
+    };
+    auto sameRow = [&](uint32_t p, uint32_t q)
+    {
+        if (offsets[p + 1] - offsets[p] != offsets[q + 1] - offsets[q])
+        {
+            return false;
+        }
+        for (size_t i = offsets[p], j = offsets[q]; i < offsets[p + 1]; i++, j++)
+        {
+            if (symbols[i] != symbols[j] || out[i] != out[j] || (next[i] == NO_STATE) != (next[j] == NO_STATE))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    return classifyRows(offsets.empty() ? 0 : offsets.size() - 1, hashRow, sameRow);
+}
+
+vector<uint32_t> sparseMooreInitialBlocks(const vector<size_t>& offsets, const vector<uint32_t>& symbols,
+    const vector<uint32_t>& out)
+{
+    auto hashRow = [&](size_t p)
+    {
+        uint64_t hash = mixHash(0, out[p]);
+        for (size_t i = offsets[p]; i < offsets[p + 1]; i++)
+        {
+            hash = mixHash(hash, symbols[i]);
+        }
+        return hash;
+    };
+    auto sameRow = [&](uint32_t p, uint32_t q)
+    {
+        return out[p] == out[q]
+            && equal(symbols.begin() + offsets[p], symbols.begin() + offsets[p + 1],
+                symbols.begin() + offsets[q], symbols.begin() + offsets[q + 1]);
+    };
+    return classifyRows(out.size(), hashRow, sameRow);
+}
+
+namespace
+{
+    template <typename Signature>
+    vector<uint32_t> roundsWith(size_t stateCount, const vector<uint32_t>& initialBlocks, const Signature& signature)
+    {
+        vector<uint32_t> blocks = initialBlocks;
+        uint32_t blockCount = canonicalizeBlocks(blocks);
+
+        // Разбиения текущего и следующего раунда меняются местами, таблица сигнатур
+        // рассчитана на худший случай (блок на состояние): память выделяется один раз
+        // на запуск, а не на раунд.
+        vector<uint32_t> newBlocks(stateCount);
+        SignatureTable table;
+        auto equal = [&](uint32_t p, uint32_t q) { return signature.same(blocks, p, q); };
+
+        while (true)
+        {
+            table.reset(stateCount);
+            for (size_t p = 0; p < stateCount; p++)
+            {
+                newBlocks[p] = table.insert(uint32_t(p), signature.hash(blocks, p), equal);
+            }
+
+            recordRefinementRound(table.size());
+            if (table.size() == blockCount)
+            {
+                break;
+            }
+            blockCount = uint32_t(table.size());
+            blocks.swap(newBlocks);
+        }
+
+        canonicalizeBlocks(blocks);
+        return blocks;
+    }
+
+    template <typename Signature>
+    vector<uint32_t> parallelWith(size_t stateCount, const vector<uint32_t>& initialBlocks, const Signature& signature,
+        ThreadPool& pool)
+    {
+        vector<uint32_t> blocks = initialBlocks;
+        uint32_t blockCount = canonicalizeBlocks(blocks);
+        if (stateCount == 0)
+        {
+            return blocks;
+        }
+
+        auto equal = [&](uint32_t p, uint32_t q) { return signature.same(blocks, p, q); };
+
+        size_t chunkCount = (stateCount + ROUND_GRAIN - 1) / ROUND_GRAIN;
+        vector<SignatureTable> localTables(chunkCount);
+        vector<vector<uint32_t>> localToGlobal(chunkCount);
+        vector<uint32_t> localIds(stateCount);
+        vector<uint32_t> newBlocks(stateCount);
+        SignatureTable globalTable;
+
+        while (true)
+        {
+            // Каждый отрезок состояний получает свою таблицу сигнатур и локальные номера классов.
+            pool.parallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk)
+            {
+                for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+                {
+                    size_t from = chunk * ROUND_GRAIN;
+                    size_t to = min(stateCount, from + ROUND_GRAIN);
+                    SignatureTable& table = localTables[chunk];
+                    table.reset(min<size_t>(to - from, size_t(blockCount) * 2));
+                    for (size_t p = from; p < to; p++)
+                    {
+                        localIds[p] = table.insert(uint32_t(p), signature.hash(blocks, p), equal);
+                    }
+                }
+            });
+
+            // Слияние идёт по отрезкам по порядку, поэтому новые номера блоков
+            // совпадают с порядком первого вхождения и не зависят от числа потоков.
+            globalTable.reset(blockCount);
+            for (size_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                const SignatureTable& table = localTables[chunk];
+                localToGlobal[chunk].resize(table.size());
+                for (uint32_t id = 0; id < table.size(); id++)
+                {
+                    localToGlobal[chunk][id] = globalTable.insert(table.representative(id), table.hash(id), equal);
+                }
+            }
+
+            pool.parallelFor(stateCount, ROUND_GRAIN, [&](size_t from, size_t to)
+            {
+                const vector<uint32_t>& remap = localToGlobal[from / ROUND_GRAIN];
+                for (size_t p = from; p < to; p++)
+                {
+                    newBlocks[p] = remap[localIds[p]];
+                }
+            });
+
+            recordRefinementRound(globalTable.size());
+            if (globalTable.size() == blockCount)
+            {
+                break;
+            }
+            blockCount = uint32_t(globalTable.size());
+            blocks.swap(newBlocks);
+        }
+
+        return blocks;
+    }
+}
+
+vector<uint32_t> refineRounds(size_t stateCount, size_t inputCount,
+    const vector<uint32_t>& next, const vector<uint32_t>& initialBlocks)
+{
+    return roundsWith(stateCount, initialBlocks, DenseSignature{ next, inputCount });
+}
+
+vector<uint32_t> refineParallel(size_t stateCount, size_t inputCount,
+    const vector<uint32_t>& next, const vector<uint32_t>& initialBlocks, ThreadPool& pool)
+{
+    return parallelWith(stateCount, initialBlocks, DenseSignature{ next, inputCount }, pool);
+}
+
+vector<uint32_t> refineSparseRounds(const vector<size_t>& offsets, const vector<uint32_t>& symbols,
+    const vector<uint32_t>& next, const vector<uint32_t>& initialBlocks)
+{
+    return roundsWith(initialBlocks.size(), initialBlocks, SparseSignature{ offsets, symbols, next });
+}
+
+vector<uint32_t> refineSparseParallel(const vector<size_t>& offsets, const vector<uint32_t>& symbols,
+    const vector<uint32_t>& next, const vector<uint32_t>& initialBlocks, ThreadPool& pool)
+{
+    return parallelWith(initialBlocks.size(), initialBlocks, SparseSignature{ offsets, symbols, next }, pool);
+}
+
+vector<uint32_t> refineHopcroft(size_t stateCount, size_t inputCount,
+    const vector<uint32_t>& next, const vector<uint32_t>& initialBlocks)
+{
+    if (stateCount == 0)
+    {
+        return {};
+    }
+
+    // Обратные переходы в формате CSR: для входа a и состояния t хранятся все p, где next(p, a) = t.
+    vector<uint32_t> inverseOffsets(inputCount * stateCount + 1, 0);
+    for (size_t p = 0; p < stateCount; p++)
+    {
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            uint32_t t = next[p * inputCount + a];
+            if (t != NO_STATE)
+            {
+                inverseOffsets[a * stateCount + t + 1]++;
+            }
+        }
+    }
+    for (size_t i = 1; i < inverseOffsets.size(); i++)
+    {
+        inverseOffsets[i] += inverseOffsets[i - 1];
+    }
+
+    vector<uint32_t> inverseSources(inverseOffsets.back());
+    vector<uint32_t> fill(inverseOffsets.begin(), inverseOffsets.end() - 1);
+    for (size_t p = 0; p < stateCount; p++)
+    {
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            uint32_t t = next[p * inputCount + a];
+            if (t != NO_STATE)
+            {
+                inverseSources[fill[a * stateCount + t]++] = uint32_t(p);
+            }
+        }
+    }
+
+    // Разбиение хранится как массив состояний, упорядоченный по блокам;
+    // location[p] — позиция состояния p в elements.
+    vector<uint32_t> blocks = initialBlocks;
+    uint32_t blockCount = canonicalizeBlocks(blocks);
+
+    vector<uint32_t> blockBegin(blockCount, 0);
+    vector<uint32_t> blockEnd(blockCount, 0);
+    vector<uint32_t> blockMarked(blockCount, 0);
+    for (auto block : blocks)
+    {
+        blockEnd[block]++;
+    }
+    uint32_t offset = 0;
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        uint32_t size = blockEnd[b];
+        blockBegin[b] = offset;
+        blockEnd[b] = offset;
+        offset += size;
+    }
+
+    vector<uint32_t> elements(stateCount);
+    vector<uint32_t> location(stateCount);
+    for (uint32_t p = 0; p < stateCount; p++)
+    {
+        location[p] = blockEnd[blocks[p]]++;
+        elements[location[p]] = p;
+    }
+
+    // В рабочий список попадают все начальные блоки, кроме наибольшего.
+    vector<uint32_t> worklist;
+    uint32_t largest = 0;
+    for (uint32_t b = 1; b < blockCount; b++)
+    {
+        if (blockEnd[b] - blockBegin[b] > blockEnd[largest] - blockBegin[largest])
+        {
+            largest = b;
+        }
+    }
+    for (uint32_t b = 0; b < blockCount; b++)
+    {
+        if (b != largest)
+        {
+            worklist.push_back(b);
+        }
+    }
+
+    vector<uint32_t> splitter;
+    vector<uint32_t> touched;
+
+    size_t splitterCount = 0;
+    while (!worklist.empty())
+    {
+        uint32_t s = worklist.back();
+        worklist.pop_back();
+        splitterCount++;
+
+        splitter.assign(elements.begin() + blockBegin[s], elements.begin() + blockEnd[s]);
+
+        for (size_t a = 0; a < inputCount; a++)
+        {
+            for (auto t : splitter)
+            {
+                size_t from = inverseOffsets[a * stateCount + t];
+                size_t to = inverseOffsets[a * stateCount + t + 1];
+                for (size_t i = from; i < to; i++)
+                {
+                    uint32_t p = inverseSources[i];
+                    uint32_t b = blocks[p];
+                    uint32_t pos = location[p];
+                    uint32_t target = blockBegin[b] + blockMarked[b];
+
+                    swap(elements[pos], elements[target]);
+                    location[elements[pos]] = pos;
+                    location[p] = target;
+
+                    if (blockMarked[b]++ == 0)
+                    {
+                        touched.push_back(b);
+                    }
+                }
+            }
+
+            for (auto b : touched)
+            {
+                uint32_t marked = blockMarked[b];
+                blockMarked[b] = 0;
+
+                uint32_t begin = blockBegin[b];
+                uint32_t end = blockEnd[b];
+                if (marked == end - begin)
+                {
+                    continue;
+                }
+
+                // Новым блоком всегда становится меньшая часть: если старый блок уже
+                // в рабочем списке, нужны обе части, иначе достаточно меньшей.
+                uint32_t newBlock = blockCount++;
+                if (marked <= end - begin - marked)
+                {
+                    blockBegin.push_back(begin);
+                    blockEnd.push_back(begin + marked);
+                    blockBegin[b] = begin + marked;
+                }
+                else
+                {
+                    blockBegin.push_back(begin + marked);
+                    blockEnd.push_back(end);
+                    blockEnd[b] = begin + marked;
+                }
+                blockMarked.push_back(0);
+
+                for (uint32_t i = blockBegin[newBlock]; i < blockEnd[newBlock]; i++)
+                {
+                    blocks[elements[i]] = newBlock;
+                }
+
+                worklist.push_back(newBlock);
+            }
+            touched.clear();
+        }
+    }
+    recordCounter("hopcroft_splitters", splitterCount);
+
+    canonicalizeBlocks(blocks);
+    return blocks;
+}
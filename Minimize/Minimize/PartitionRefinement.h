@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Automaton.h"
+
+class ThreadPool;
+
+// Начальное разбиение автомата Мили: состояния различаются строкой выходов
+// и набором определённых переходов (out хранится так же, как next).
+std::vector<uint32_t> mealyInitialBlocks(std::size_t stateCount, std::size_t inputCount,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& out);
+
+// Начальное разбиение автомата Мура: выход состояния и набор определённых переходов.
+std::vector<uint32_t> mooreInitialBlocks(std::size_t stateCount, std::size_t inputCount,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& out);
+
+// Минимизация методом Хопкрофта по рабочему списку разделителей.
+// next хранит переходы построчно по состояниям: next[state * inputCount + input].
+// initialBlocks задаёт начальное разбиение (номера классов 0..m-1) и должно
+// различать состояния с разным набором определённых переходов.
+// Возвращает номер блока для каждого состояния; блоки пронумерованы
+// в порядке первого вхождения, поэтому блок начального состояния равен 0.
+std::vector<uint32_t> refineHopcroft(std::size_t stateCount, std::size_t inputCount,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& initialBlocks);
+
+// Минимизация по раундам: на каждом раунде состояния блока разделяются по
+// номерам блоков своих преемников, пока число блоков не перестанет расти.
+std::vector<uint32_t> refineRounds(std::size_t stateCount, std::size_t inputCount,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& initialBlocks);
+
+// Те же раунды, но сигнатуры состояний считаются параллельно на pool: каждый поток
+// хеширует свой отрезок состояний, затем классы сливаются по порядку отрезков.
+// Результат не зависит от числа потоков и совпадает с refineRounds.
+std::vector<uint32_t> refineParallel(std::size_t stateCount, std::size_t inputCount,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& initialBlocks, ThreadPool& pool);
+
+// Начальные разбиения и раунды для переходов в формате CSR, как в SparseMealy и SparseMoore:
+// переходы состояния s занимают позиции offsets[s]..offsets[s + 1] по возрастанию входа,
+// отсутствующие ячейки не определены. Время пропорционально числу хранимых переходов,
+// а разбиение совпадает с плотными функциями для той же таблицы.
+std::vector<uint32_t> sparseMealyInitialBlocks(const std::vector<std::size_t>& offsets,
+    const std::vector<uint32_t>& symbols, const std::vector<uint32_t>& next, const std::vector<uint32_t>& out);
+std::vector<uint32_t> sparseMooreInitialBlocks(const std::vector<std::size_t>& offsets,
+    const std::vector<uint32_t>& symbols, const std::vector<uint32_t>& out);
+std::vector<uint32_t> refineSparseRounds(const std::vector<std::size_t>& offsets, const std::vector<uint32_t>& symbols,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& initialBlocks);
+std::vector<uint32_t> refineSparseParallel(const std::vector<std::size_t>& offsets, const std::vector<uint32_t>& symbols,
+    const std::vector<uint32_t>& next, const std::vector<uint32_t>& initialBlocks, ThreadPool& pool);
+
+// Перенумерация блоков в порядке первого вхождения. Возвращает число блоков.
+uint32_t canonicalizeBlocks(std::vector<uint32_t>& blocks);
@@ -0,0 +1,851 @@
+﻿#include "Server.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "Automaton.h"
+#include "BinaryFormat.h"
+#include "Conversion.h"
+#include "CsvReader.h"
+#include "CsvWriter.h"
+#include "Diagnostics.h"
+#include "Minimization.h"
+#include "PartitionRefinement.h"
+#include "Runner.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+struct ResidentMachine
+{
+    AutomatonKind kind = AutomatonKind::Mealy;
+    MealyTable mealy;
+    MooreTable moore;
+
+    // Строятся при первом запросе и дальше только читаются.
+    once_flag runnerOnce;
+    unique_ptr<AutomatonRunner> runner;
+    once_flag blocksOnce;
+    vector<uint32_t> blocks;
+
+    size_t stateCount() const { return kind == AutomatonKind::Mealy ? mealy.stateCount() : moore.stateCount(); }
+
+    const AutomatonRunner& getRunner()
+    {
+        call_once(runnerOnce, [this]
+        {
+            runner = kind == AutomatonKind::Mealy ? make_unique<AutomatonRunner>(mealy) : make_unique<AutomatonRunner>(moore);
+        });
+        return *runner;
+    }
+
+    // Классы эквивалентности всех состояний, включая недостижимые из начального.
+    const vector<uint32_t>& getBlocks()
+    {
+        call_once(blocksOnce, [this]
+        {
+            if (kind == AutomatonKind::Mealy)
+            {
+                blocks = refineRounds(mealy.stateCount(), mealy.inputCount(), mealy.next,
+                    mealyInitialBlocks(mealy.stateCount(), mealy.inputCount(), mealy.next, mealy.out));
+            }
+            else
+            {
+                blocks = refineRounds(moore.stateCount(), moore.inputCount(), moore.next,
+                    mooreInitialBlocks(moore.stateCount(), moore.inputCount(), moore.next, moore.out));
+            }
+        });
+        return blocks;
+    }
+};
+
+namespace
+{
+    struct Reply
+    {
+        string info;
+        string body;
+    };
+
+    vector<string> splitWords(string_view line)
+    {
+        vector<string> words;
+        size_t i = 0;
+        while (i < line.size())
+        {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+            {
+                i++;
+            }
+            size_t begin = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+            {
+                i++;
+            }
+            if (i > begin)
+            {
+                words.emplace_back(line.substr(begin, i - begin));
+            }
+        }
+        return words;
+    }
+
+    void expectArgs(const vector<string>& args, size_t count, const string& usage)
+    {
+        if (args.size() != count)
+        {
+            throw runtime_error("Usage: " + usage);
+        }
+    }
+
+    AutomatonKind parseKind(const string& kind)
+    {
+        if (kind == "mealy")
+        {
+            return AutomatonKind::Mealy;
+        }
+        if (kind == "moore")
+        {
+            return AutomatonKind::Moore;
+        }
+        throw runtime_error("Unknown automaton type " + kind);
+    }
+
+    const char* kindName(AutomatonKind kind)
+    {
+        return kind == AutomatonKind::Mealy ? "mealy" : "moore";
+    }
+
+    string describe(const ResidentMachine& machine)
+    {
+        size_t inputCount = machine.kind == AutomatonKind::Mealy ? machine.mealy.inputCount() : machine.moore.inputCount();
+        return "states=" + to_string(machine.stateCount()) + " inputs=" + to_string(inputCount);
+    }
+
+    StateId stateByName(const ResidentMachine& machine, const string& name)
+    {
+        const NameTable& states = machine.kind == AutomatonKind::Mealy ? machine.mealy.states : machine.moore.states;
+        StateId state = states.find(name);
+        if (state == NO_STATE)
+        {
+            throw runtime_error("Unknown state " + name);
+        }
+        return state;
+    }
+}
+
+MachineServer::MachineServer(ThreadPool& pool, string engine)
+    : m_pool(pool)
+    , m_engine(move(engine))
+{
+}
+
+MachineServer::~MachineServer() = default;
+
+shared_ptr<ResidentMachine> MachineServer::find(const string& id) const
+{
+    shared_lock<shared_mutex> lock(m_mutex);
+    auto it = m_machines.find(id);
+    if (it == m_machines.end())
+    {
+        throw runtime_error("Unknown machine " + id);
+    }
+    return it->second;
+}
+
+void MachineServer::put(const string& id, shared_ptr<ResidentMachine> machine)
+{
+    // Запросы, уже получившие прежний автомат, дорабатывают с ним.
+    unique_lock<shared_mutex> lock(m_mutex);
+    m_machines[id] = move(machine);
+}
+
+string MachineServer::handle(string_view request)
+{
+    size_t lineEnd = request.find('\n');
+    vector<string> args = splitWords(request.substr(0, lineEnd));
+    string_view body = lineEnd == string_view::npos ? string_view() : request.substr(lineEnd + 1);
+
+    Reply reply;
+    try
+    {
+        const string command = args.empty() ? string() : args[0];
+        if (command == "load")
+        {
+            if (args.size() != 3 && args.size() != 4)
+            {
+                throw runtime_error("Usage: load <id> <mealy|moore> [<file>]");
+            }
+            auto machine = make_shared<ResidentMachine>();
+            machine->kind = parseKind(args[2]);
+            FileFormat format = args.size() == 4 ? resolveFormat(args[3], "") : FileFormat::Csv;
+            if (format == FileFormat::Cpp)
+            {
+                throw runtime_error("Generated C++ source can not be read as an automaton: " + args[3]);
+            }
+            if (machine->kind == AutomatonKind::Mealy)
+            {
+                if (args.size() == 3)
+                {
+                    parseMealyCsv(body, machine->mealy, m_pool);
+                }
+                else if (format == FileFormat::Binary)
+                {
+                    loadMealyBinary(args[3], machine->mealy);
+                }
+                else
+                {
+                    loadMealyCsv(args[3], machine->mealy, m_pool);
+                }
+            }
+            else
+            {
+                if (args.size() == 3)
+                {
+                    parseMooreCsv(body, machine->moore, m_pool);
+                }
+                else if (format == FileFormat::Binary)
+                {
+                    loadMooreBinary(args[3], machine->moore);
+                }
+                else
+                {
+                    loadMooreCsv(args[3], machine->moore, m_pool);
+                }
+            }
+            reply.info = describe(*machine);
+            put(args[1], move(machine));
+        }
+        else if (command == "unload")
+        {
+            expectArgs(args, 2, "unload <id>");
+            unique_lock<shared_mutex> lock(m_mutex);
+            if (m_machines.erase(args[1]) == 0)
+            {
+                throw runtime_error("Unknown machine " + args[1]);
+            }
+        }
+        else if (command == "list")
+        {
+            expectArgs(args, 1, "list");
+            shared_lock<shared_mutex> lock(m_mutex);
+            for (const auto& entry : m_machines)
+            {
+                reply.body += entry.first + " " + kindName(entry.second->kind) + " "
+                    + to_string(entry.second->stateCount()) + "\n";
+            }
+        }
+        else if (command == "get")
+        {
+            expectArgs(args, 2, "get <id>");
+            auto machine = find(args[1]);
+            ostringstream output;
+            if (machine->kind == AutomatonKind::Mealy)
+            {
+                writeMealyCsv(output, machine->mealy, m_pool);
+            }
+            else
+            {
+                writeMooreCsv(output, machine->moore, m_pool);
+            }
+            reply.body = output.str();
+        }
+        else if (command == "minimize")
+        {
+            expectArgs(args, 3, "minimize <id> <result-id>");
+            auto machine = find(args[1]);
+            auto result = make_shared<ResidentMachine>();
+            result->kind = machine->kind;
+            if (machine->kind == AutomatonKind::Mealy)
+            {
+                result->mealy = mealyMin(findMealyReachableStates(machine->mealy, m_pool), m_engine, m_pool);
+            }
+            else
+            {
+                result->moore = mooreMin(findMooreReachableStates(machine->moore, m_pool), m_engine, m_pool);
+            }
+            reply.info = describe(*result);
+            put(args[2], move(result));
+        }
+        else if (command == "convert")
+        {
+            expectArgs(args, 3, "convert <id> <result-id>");
+            auto machine = find(args[1]);
+            auto result = make_shared<ResidentMachine>();
+            if (machine->kind == AutomatonKind::Mealy)
+            {
+                // mealyToMoore может дописать выход в таблицу, поэтому общий автомат копируется.
+                MealyTable mealy = machine->mealy;
+                result->kind = AutomatonKind::Moore;
+                result->moore = mealyToMoore(mealy, m_pool);
+            }
+            else
+            {
+                result->kind = AutomatonKind::Mealy;
+                result->mealy = mooreToMealy(machine->moore);
+            }
+            reply.info = describe(*result);
+            put(args[2], move(result));
+        }
+        else if (command == "run")
+        {
+            expectArgs(args, 2, "run <id>");
+            auto machine = find(args[1]);
+            ostringstream output;
+            ostringstream errors;
+            RunSummary summary = runTextStream(machine->getRunner(), body, output, errors, m_pool);
+            reply.info = "lines=" + to_string(summary.lines) + " failed=" + to_string(summary.failedLines);
+            reply.body = output.str();
+        }
+        else if (command == "equiv")
+        {
+            expectArgs(args, 4, "equiv <id> <state> <state>");
+            auto machine = find(args[1]);
+            StateId first = stateByName(*machine, args[2]);
+            StateId second = stateByName(*machine, args[3]);
+            const vector<uint32_t>& blocks = machine->getBlocks();
+            reply.info = blocks[first] == blocks[second] ? "equivalent" : "distinct";
+        }
+        else if (command == "shutdown")
+        {
+            expectArgs(args, 1, "shutdown");
+            m_stop = true;
+        }
+        else
+        {
+            throw runtime_error(command.empty() ? string("Empty request") : "Unknown command " + command);
+        }
+    }
+    catch (const exception& e)
+    {
+        return "ERROR " + string(e.what()) + "\n";
+    }
+
+    return (reply.info.empty() ? string("OK") : "OK " + reply.info) + "\n" + reply.body;
+}
+
+#ifndef _WIN32
+
+namespace
+{
+    // Больше этого кадры не принимаются и не отправляются; большие таблицы загружаются
+    // командой load из файла на стороне сервера.
+    const uint64_t MAX_FRAME_SIZE = uint64_t(256) << 20;
+    constexpr size_t FRAME_HEADER_SIZE = 8;
+    constexpr size_t READ_CHUNK_SIZE = size_t(64) << 10;
+    // Столько ждёт запись ответа клиенту, который его не читает.
+    constexpr int WRITE_TIMEOUT_MS = 30000;
+
+    [[noreturn]] void throwSystemError(const string& what)
+    {
+        throw runtime_error(what + ": " + strerror(errno));
+    }
+
+    uint64_t decodeFrameSize(const char* header)
+    {
+        uint64_t size = 0;
+        for (int i = 7; i >= 0; i--)
+        {
+            size = size << 8 | (unsigned char)header[i];
+        }
+        if (size > MAX_FRAME_SIZE)
+        {
+            throw runtime_error("Frame of " + to_string(size) + " bytes is too large");
+        }
+        return size;
+    }
+
+    // Читает до size байт; меньше — только если соединение закрыто.
+    size_t readAll(int fd, char* data, size_t size)
+    {
+        size_t done = 0;
+        while (done < size)
+        {
+            ssize_t count = ::read(fd, data + done, size - done);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count < 0)
+            {
+                throwSystemError("Socket read failed");
+            }
+            if (count == 0)
+            {
+                break;
+            }
+            done += size_t(count);
+        }
+        return done;
+    }
+
+    // Пишет всё; для неблокирующего сокета ждёт готовности не дольше WRITE_TIMEOUT_MS.
+    void writeAll(int fd, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t count = ::write(fd, data, size);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                pollfd writable{ fd, POLLOUT, 0 };
+                int result = ::poll(&writable, 1, WRITE_TIMEOUT_MS);
+                if (result == 0)
+                {
+                    throw runtime_error("Socket write timed out");
+                }
+                if (result < 0 && errno != EINTR)
+                {
+                    throwSystemError("poll failed");
+                }
+                continue;
+            }
+            if (count < 0)
+            {
+                throwSystemError("Socket write failed");
+            }
+            data += count;
+            size -= size_t(count);
+        }
+    }
+
+    // Дописывает в buffer байты, доступные без ожидания. false — клиент закрыл соединение.
+    bool readAvailable(int fd, string& buffer)
+    {
+        char chunk[READ_CHUNK_SIZE];
+        while (buffer.size() < FRAME_HEADER_SIZE + MAX_FRAME_SIZE)
+        {
+            ssize_t count = ::read(fd, chunk, sizeof(chunk));
+            if (count > 0)
+            {
+                buffer.append(chunk, size_t(count));
+            }
+            else if (count == 0)
+            {
+                return false;
+            }
+            else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return true;
+            }
+            else if (errno != EINTR)
+            {
+                throwSystemError("Socket read failed");
+            }
+        }
+        return true;
+    }
+
+    // Забирает из начала buffer первый полный кадр; false, если он ещё не дочитан.
+    bool takeFrame(string& buffer, string& payload)
+    {
+        if (buffer.size() < FRAME_HEADER_SIZE)
+        {
+            return false;
+        }
+        size_t size = size_t(decodeFrameSize(buffer.data()));
+        if (buffer.size() - FRAME_HEADER_SIZE < size)
+        {
+            return false;
+        }
+        payload.assign(buffer, FRAME_HEADER_SIZE, size);
+        buffer.erase(0, FRAME_HEADER_SIZE + size);
+        return true;
+    }
+
+    sockaddr_un socketAddress(const string& socketPath)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path))
+        {
+            throw runtime_error("Invalid socket path: " + socketPath);
+        }
+        memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        return address;
+    }
+}
+
+bool readFrame(int fd, string& payload)
+{
+    char header[FRAME_HEADER_SIZE];
+    size_t headerSize = readAll(fd, header, sizeof(header));
+    if (headerSize == 0)
+    {
+        return false;
+    }
+    if (headerSize != sizeof(header))
+    {
+        throw runtime_error("Connection closed inside a frame header");
+    }
+
+    // Буфер растёт по мере прихода данных, а не по заявленной в заголовке длине.
+    uint64_t size = decodeFrameSize(header);
+    payload.clear();
+    char chunk[READ_CHUNK_SIZE];
+    while (payload.size() < size)
+    {
+        size_t piece = size_t(min<uint64_t>(size - payload.size(), sizeof(chunk)));
+        if (readAll(fd, chunk, piece) != piece)
+        {
+            throw runtime_error("Connection closed inside a frame");
+        }
+        payload.append(chunk, piece);
+    }
+    return true;
+}
+
+void writeFrame(int fd, string_view payload)
+{
+    if (payload.size() > MAX_FRAME_SIZE)
+    {
+        throw runtime_error("Frame of " + to_string(payload.size()) + " bytes is too large");
+    }
+    char header[FRAME_HEADER_SIZE];
+    uint64_t size = payload.size();
+    for (int i = 0; i < 8; i++)
+    {
+        header[i] = char(size >> (8 * i));
+    }
+    writeAll(fd, header, sizeof(header));
+    writeAll(fd, payload.data(), payload.size());
+}
+
+void serveUnixSocket(const string& socketPath, MachineServer& server, size_t workerCount)
+{
+    // Запись в закрытое клиентом соединение должна давать ошибку, а не завершать сервер.
+    signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un address = socketAddress(socketPath);
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        throwSystemError("Cannot create socket");
+    }
+    // Сокет, оставшийся от прошлого запуска, заменяется; другие файлы не трогаются.
+    struct stat info;
+    if (::lstat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+    {
+        ::unlink(socketPath.c_str());
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener, SOMAXCONN) != 0)
+    {
+        int error = errno;
+        ::close(listener);
+        errno = error;
+        throwSystemError("Cannot listen on " + socketPath);
+    }
+
+    // Рабочие потоки возвращают соединение через returned и будят poll записью в wake.
+    int wake[2];
+    if (::pipe(wake) != 0)
+    {
+        throwSystemError("Cannot create pipe");
+    }
+    ::fcntl(wake[0], F_SETFL, O_NONBLOCK);
+
+    // Запросы читает только цикл poll: сокеты неблокирующие, недочитанный кадр копится
+    // в буфере соединения, и медленный клиент не занимает рабочий поток.
+    struct Request
+    {
+        int fd;
+        string payload;
+    };
+    struct Returned
+    {
+        int fd;
+        bool keep;
+    };
+
+    mutex queueMutex;
+    condition_variable hasWork;
+    deque<Request> ready;
+    vector<Returned> returned;
+    bool stopping = false;
+
+    auto notifyPoll = [&wake]
+    {
+        char byte = 0;
+        ssize_t ignored = ::write(wake[1], &byte, 1);
+        (void)ignored;
+    };
+    auto logDropped = [](const exception& e)
+    {
+        if (logEnabled(Verbosity::Info))
+        {
+            cerr << "[info] connection dropped: " << e.what() << "\n";
+        }
+    };
+
+    vector<thread> workers;
+    for (size_t i = 0; i < max<size_t>(1, workerCount); i++)
+    {
+        workers.emplace_back([&]
+        {
+            while (true)
+            {
+                Request request;
+                {
+                    unique_lock<mutex> lock(queueMutex);
+                    hasWork.wait(lock, [&] { return stopping || !ready.empty(); });
+                    if (ready.empty())
+                    {
+                        return;
+                    }
+                    request = move(ready.front());
+                    ready.pop_front();
+                }
+
+                bool keep = true;
+                try
+                {
+                    string response = server.handle(request.payload);
+                    if (response.size() > MAX_FRAME_SIZE)
+                    {
+                        response = "ERROR Response of " + to_string(response.size()) + " bytes is too large\n";
+                    }
+                    writeFrame(request.fd, response);
+                }
+                catch (const exception& e)
+                {
+                    logDropped(e);
+                    keep = false;
+                }
+
+                {
+                    lock_guard<mutex> lock(queueMutex);
+                    returned.push_back({ request.fd, keep });
+                }
+                notifyPoll();
+            }
+        });
+    }
+
+    // Соединения, ждущие запроса, и их недочитанные байты.
+    unordered_map<int, string> buffers;
+    vector<int> idle;
+    vector<pollfd> polled;
+    auto closeConnection = [&buffers](int fd)
+    {
+        buffers.erase(fd);
+        ::close(fd);
+    };
+    // Отдаёт рабочим потокам готовый кадр соединения; false, если кадр ещё не пришёл.
+    auto dispatch = [&](int fd)
+    {
+        Request request{ fd, string() };
+        if (!takeFrame(buffers[fd], request.payload))
+        {
+            return false;
+        }
+        lock_guard<mutex> lock(queueMutex);
+        ready.push_back(move(request));
+        hasWork.notify_one();
+        return true;
+    };
+
+    while (!server.stopRequested())
+    {
+        polled.assign({ { listener, POLLIN, 0 }, { wake[0], POLLIN, 0 } });
+        for (int fd : idle)
+        {
+            polled.push_back({ fd, POLLIN, 0 });
+        }
+        if (::poll(polled.data(), polled.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throwSystemError("poll failed");
+        }
+
+        vector<int> stillIdle;
+        for (size_t i = 0; i < idle.size(); i++)
+        {
+            int fd = idle[i];
+            if (polled[i + 2].revents == 0)
+            {
+                stillIdle.push_back(fd);
+                continue;
+            }
+            try
+            {
+                bool open = readAvailable(fd, buffers[fd]);
+                if (dispatch(fd))
+                {
+                    continue;
+                }
+                if (open)
+                {
+                    stillIdle.push_back(fd);
+                    continue;
+                }
+                if (!buffers[fd].empty())
+                {
+                    throw runtime_error("Connection closed inside a frame");
+                }
+            }
+            catch (const exception& e)
+            {
+                logDropped(e);
+            }
+            closeConnection(fd);
+        }
+        idle.swap(stillIdle);
+
+        if (polled[1].revents != 0)
+        {
+            char buffer[256];
+            while (::read(wake[0], buffer, sizeof(buffer)) > 0)
+            {
+            }
+            vector<Returned> done;
+            {
+                lock_guard<mutex> lock(queueMutex);
+                done.swap(returned);
+            }
+            for (const auto& connection : done)
+            {
+                try
+                {
+                    // Клиент мог прислать следующий запрос, не дожидаясь ответа.
+                    if (connection.keep && !dispatch(connection.fd))
+                    {
+                        idle.push_back(connection.fd);
+                    }
+                    else if (!connection.keep)
+                    {
+                        closeConnection(connection.fd);
+                    }
+                }
+                catch (const exception& e)
+                {
+                    logDropped(e);
+                    closeConnection(connection.fd);
+                }
+            }
+        }
+        if (polled[0].revents != 0)
+        {
+            int client = ::accept(listener, nullptr, nullptr);
+            if (client >= 0)
+            {
+                ::fcntl(client, F_SETFD, FD_CLOEXEC);
+                ::fcntl(client, F_SETFL, O_NONBLOCK);
+                buffers[client];
+                idle.push_back(client);
+            }
+        }
+    }
+
+    // Начатые запросы дорабатываются, соединения закрываются.
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+        for (const auto& request : ready)
+        {
+            ::close(request.fd);
+        }
+        ready.clear();
+    }
+    hasWork.notify_all();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    for (int fd : idle)
+    {
+        ::close(fd);
+    }
+    for (const auto& connection : returned)
+    {
+        ::close(connection.fd);
+    }
+    ::close(listener);
+    ::close(wake[0]);
+    ::close(wake[1]);
+    ::unlink(socketPath.c_str());
+}
+
+int connectUnixSocket(const string& socketPath)
+{
+    signal(SIGPIPE, SIG_IGN);
+    sockaddr_un address = socketAddress(socketPath);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        throwSystemError("Cannot create socket");
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        throwSystemError("Cannot connect to " + socketPath);
+    }
+    return fd;
+}
+
+void closeSocket(int fd)
+{
+    ::close(fd);
+}
+
+#else
+
+namespace
+{
+    [[noreturn]] void throwUnsupported()
+    {
+        throw runtime_error("Server mode needs Unix domain sockets and is not supported on Windows");
+    }
+}
+
+bool readFrame(int, string&)
+{
+    throwUnsupported();
+}
+
+void writeFrame(int, string_view)
+{
+    throwUnsupported();
+}
+
+void serveUnixSocket(const string&, MachineServer&, size_t)
+{
+    throwUnsupported();
+}
+
+int connectUnixSocket(const string&)
+{
+    throwUnsupported();
+}
+
+void closeSocket(int)
+{
+}
+
+#endif
@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Режим сервера: автоматы загружаются один раз, хранятся в памяти под именами
+// и обслуживают запросы клиентов через сокет Unix. Запрос и ответ передаются
+// кадрами: длина (8 байт, little-endian, не больше 256 МиБ) и текст. Первая строка запроса — команда
+// с аргументами через пробел, остальное — тело. Первая строка ответа — "OK"
+// (возможно, с пояснением через пробел) или "ERROR <сообщение>", дальше тело ответа.
+//
+//   load <id> <mealy|moore> [<file>]  файл на стороне сервера (CSV или .bin) или CSV в теле
+//   unload <id>
+//   list                              строки "<id> <mealy|moore> <states>"
+//   get <id>                          CSV автомата
+//   minimize <id> <result-id>         минимальный автомат под новым именем
+//   convert <id> <result-id>          Мили в Мура или Мура в Мили
+//   run <id>                          тело — последовательности входов по строке, ответ — выходы
+//   equiv <id> <state> <state>        "OK equivalent" или "OK distinct"
+//   shutdown
+
+struct ResidentMachine;
+
+// Обработка запросов без привязки к сокетам. Автоматы после загрузки не меняются,
+// поэтому запросы к ним выполняются параллельно; таблица имён защищена
+// разделяемой блокировкой и берётся на запись только при load, unload и сохранении результата.
+class MachineServer
+{
+public:
+    MachineServer(ThreadPool& pool, std::string engine);
+    ~MachineServer();
+
+    std::string handle(std::string_view request);
+    bool stopRequested() const { return m_stop; }
+
+private:
+    std::shared_ptr<ResidentMachine> find(const std::string& id) const;
+    void put(const std::string& id, std::shared_ptr<ResidentMachine> machine);
+
+    ThreadPool& m_pool;
+    std::string m_engine;
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<ResidentMachine>> m_machines;
+    std::atomic<bool> m_stop{ false };
+};
+
+// Кадры протокола. readFrame возвращает false, если соединение закрыто до начала кадра.
+bool readFrame(int fd, std::string& payload);
+void writeFrame(int fd, std::string_view payload);
+
+// Принимает соединения на socketPath, пока не придёт shutdown. Кадры запросов дочитываются
+// в цикле poll без блокировки, готовые запросы обслуживают workerCount потоков, поэтому
+// медленные клиенты и соединения между запросами потоков не занимают.
+// В Windows сокеты Unix не поддерживаются, обе функции бросают исключение.
+void serveUnixSocket(const std::string& socketPath, MachineServer& server, size_t workerCount);
+int connectUnixSocket(const std::string& socketPath);
+void closeSocket(int fd);